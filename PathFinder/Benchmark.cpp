@@ -0,0 +1,295 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <sstream>
+
+#include "PathFinder.h"
+#include "MoveRule.h"
+#include "PreciseTimer.h"
+
+
+namespace fournier
+{
+	/// <summary>Number of cells whose obstacle is set or removed by checkMapChanges() in each frame.</summary>
+	static const int CHANGED_OBSTACLES_PER_FRAME = 8;
+
+	/// <summary>Width and depth of the rectangle of columns raised or lowered by checkMapChanges() in each frame.</summary>
+	static const int CHANGED_COLUMNS_SIZE = 4;
+
+	/// <summary>Largest change of the height of a column, in cubes.</summary>
+	static const int MAXIMUM_HEIGHT_CHANGE = 2;
+
+	vector<int> Benchmark::mFinishedSearchList;
+
+	double BenchmarkReport::getNodesPerSecond() const
+	{
+		if (AStarComputeTime <= 0)
+			return 0.0;
+		return (double)numberNodeChecked * 1000000.0 / (double)AStarComputeTime;
+	}
+
+	Benchmark::Benchmark(unsigned int _seed, int _numberQuery)
+	{
+		mt19937 generator(_seed);
+		uniform_int_distribution<int> positionX(0, NavigationGrid::getSizeX() - 1);
+		uniform_int_distribution<int> positionY(0, NavigationGrid::getSizeY() - 1);
+
+		for (int n = 0; n < _numberQuery; ++n)
+		{
+			mStartPositionList.push_back(WorldPosition(positionX(generator), positionY(generator), 0));
+			mEndPositionList.push_back(WorldPosition(positionX(generator), positionY(generator), 0));
+		}
+	}
+
+	BenchmarkReport Benchmark::run(const PathParam& _parameters) const
+	{
+		BenchmarkReport report;
+
+		for (int n = 0; n < (int)mStartPositionList.size(); ++n)
+		{
+			PathResult result;
+			if (!runQuery(n, _parameters, _parameters.openListEngine, result))
+				continue;
+
+			report.numberQuery += 1;
+			report.numberPathFound += result.isPathFound ? 1 : 0;
+			report.numberNodeChecked += result.numberNodeChecked;
+			report.AStarComputeTime += result.AStarComputeTime;
+			report.totalComputeTime += result.totalComputeTime;
+			report.totalPathCost += getPathCost(result);
+		}
+
+		return report;
+	}
+
+	int Benchmark::checkOpenListEngines(const PathParam& _parameters) const
+	{
+		int numberMismatch = 0;
+
+		for (int n = 0; n < (int)mStartPositionList.size(); ++n)
+		{
+			PathResult heapResult, bucketResult;
+			if (!runQuery(n, _parameters, OPEN_LIST_BINARY_HEAP, heapResult) || !runQuery(n, _parameters, OPEN_LIST_BUCKET_QUEUE, bucketResult))
+				continue;
+
+			long long heapCost = getPathCost(heapResult);
+			long long bucketCost = getPathCost(bucketResult);
+			if (heapResult.isPathFound != bucketResult.isPathFound || bucketCost > heapCost || (!_parameters.allowDiagonalMovements && bucketCost != heapCost))
+				numberMismatch += 1;
+		}
+
+		return numberMismatch;
+	}
+
+	int Benchmark::checkMapChanges(const PathParam& _parameters, ProceduralGridSource* _gridSource, unsigned int _seed) const
+	{
+		PathFinder* pathFinder = PathFinder::getInstance();
+		mt19937 generator(_seed);
+		uniform_int_distribution<int> positionX(0, NavigationGrid::getSizeX() - 1);
+		uniform_int_distribution<int> positionY(0, NavigationGrid::getSizeY() - 1);
+		uniform_int_distribution<int> heightChange(-MAXIMUM_HEIGHT_CHANGE, MAXIMUM_HEIGHT_CHANGE);
+
+		int numberQuery = (int)mStartPositionList.size();
+		vector<PathParam*> parametersList(numberQuery, nullptr);
+		vector<PathResult*> resultList(numberQuery, nullptr);
+		map<int, int> queryOfSearchList;
+		vector<WorldPosition> obstacleList;
+		int numberFailure = 0;
+		mFinishedSearchList.clear();
+
+		// The paths given since the last update() are checked on the map they were found on
+		auto checkFinishedSearches = [&]()
+		{
+			for (auto it = mFinishedSearchList.begin(); it != mFinishedSearchList.end(); ++it)
+			{
+				auto search = queryOfSearchList.find(*it);
+				if (search == queryOfSearchList.end())
+					continue;
+
+				int query = search->second;
+				queryOfSearchList.erase(search);
+
+				const PathResult* result = resultList[query];
+				bool isPassed = !result->isPathFound || pathFinder->isPathWalkable(parametersList[query], result->waypointsList);
+				if (isPassed && isFollowingChanges(_parameters))
+				{
+					PathResult newResult;
+					isPassed = runQuery(query, _parameters, _parameters.openListEngine, newResult) &&
+						newResult.isPathFound == result->isPathFound && (!result->isPathFound || getPathCost(newResult) == getPathCost(*result));
+				}
+				numberFailure += isPassed ? 0 : 1;
+
+				delete parametersList[query];
+				delete resultList[query];
+				parametersList[query] = nullptr;
+				resultList[query] = nullptr;
+			}
+			mFinishedSearchList.clear();
+		};
+
+		int nextQuery = 0;
+		while (nextQuery < numberQuery || !queryOfSearchList.empty())
+		{
+			// The changes of the frame are applied together at the start of update(), half of them open a way the searches may have found blocked
+			for (int n = 0; n < CHANGED_OBSTACLES_PER_FRAME; ++n)
+			{
+				if (!obstacleList.empty() && (generator() & 1) != 0)
+				{
+					int obstacle = generator() % obstacleList.size();
+					pathFinder->queueObstacle(obstacleList[obstacle], false);
+					obstacleList[obstacle] = obstacleList.back();
+					obstacleList.pop_back();
+				}
+				else
+				{
+					obstacleList.push_back(WorldPosition(positionX(generator), positionY(generator), 0));
+					pathFinder->queueObstacle(obstacleList.back(), true);
+				}
+			}
+
+			if (_gridSource != nullptr)
+			{
+				int x = positionX(generator);
+				int y = positionY(generator);
+				int width = min(CHANGED_COLUMNS_SIZE, NavigationGrid::getSizeX() - x);
+				int depth = min(CHANGED_COLUMNS_SIZE, NavigationGrid::getSizeY() - y);
+				for (int j = 0; j < depth; ++j)
+				{
+					for (int i = 0; i < width; ++i)
+					{
+						int height = max(0, min(MAT_HEIGHT_CUBES - 1, _gridSource->getHeight(x + i, y + j) + heightChange(generator)));
+						_gridSource->setColumn(x + i, y + j, height, _gridSource->getType(x + i, y + j));
+					}
+				}
+				pathFinder->queueColumnsChanged(x, y, width, depth);
+			}
+
+			pathFinder->update();
+			checkFinishedSearches();
+
+			// A search answered by the cache or the components is given with the next update(), which must not change the map
+			if (nextQuery < numberQuery)
+			{
+				PathParam* parameters = new PathParam(mStartPositionList[nextQuery], mEndPositionList[nextQuery], _parameters.walkableCubeTypeList, _parameters.allowDiagonalMovements, _parameters.maximumJumpHeight, _parameters.maximumFallHeight);
+				parameters->openListEngine = _parameters.openListEngine;
+				parameters->searchAlgorithm = _parameters.searchAlgorithm;
+				parameters->useLandmarkHeuristic = _parameters.useLandmarkHeuristic;
+				parametersList[nextQuery] = parameters;
+				resultList[nextQuery] = new PathResult();
+
+				int id = pathFinder->startSearch(parameters, resultList[nextQuery], &Benchmark::onSearchFinished);
+				if (id != -1)
+				{
+					queryOfSearchList[id] = nextQuery;
+				}
+				else
+				{
+					delete parametersList[nextQuery];
+					delete resultList[nextQuery];
+					parametersList[nextQuery] = nullptr;
+					resultList[nextQuery] = nullptr;
+				}
+				++nextQuery;
+			}
+
+			pathFinder->update();
+			checkFinishedSearches();
+		}
+
+		// The map keeps the changed columns, like the source
+		for (auto it = obstacleList.begin(); it != obstacleList.end(); ++it)
+			pathFinder->queueObstacle(*it, false);
+		pathFinder->update();
+
+		return numberFailure;
+	}
+
+	void Benchmark::onSearchFinished(int _id, PathParam*, PathResult*)
+	{
+		mFinishedSearchList.push_back(_id);
+	}
+
+	bool Benchmark::runQuery(int _query, const PathParam& _parameters, OpenListEngine _openListEngine, PathResult& _result) const
+	{
+		PathParam parameters(mStartPositionList[_query], mEndPositionList[_query], _parameters.walkableCubeTypeList, _parameters.allowDiagonalMovements, _parameters.maximumJumpHeight, _parameters.maximumFallHeight);
+		parameters.openListEngine = _openListEngine;
+		parameters.searchAlgorithm = _parameters.searchAlgorithm;
+		parameters.useLandmarkHeuristic = _parameters.useLandmarkHeuristic;
+
+		// The queries were maybe run with other parameters giving the same route, the path must not come from the cache
+		PathFinder::getInstance()->clearPathCache();
+
+		return PathFinder::getInstance()->findPath(&parameters, &_result);
+	}
+
+	long long Benchmark::getPathCost(const PathResult& _result)
+	{
+		long long cost = 0;
+
+		for (int n = 1; n < (int)_result.waypointsList.size(); ++n)
+		{
+			int distanceX = abs(_result.waypointsList[n].x - _result.waypointsList[n - 1].x);
+			int distanceY = abs(_result.waypointsList[n].y - _result.waypointsList[n - 1].y);
+			int diagonal = min(distanceX, distanceY);
+			cost += diagonal * MoveRule::COST_DIAGONAL + (distanceX + distanceY - 2 * diagonal) * MoveRule::COST_STRAIGHT;
+		}
+
+		return cost;
+	}
+
+	bool Benchmark::isFollowingChanges(const PathParam& _parameters)
+	{
+		// A hierarchical path depends on the graph of the clusters it went through
+		if (_parameters.searchAlgorithm == SEARCH_HIERARCHICAL)
+			return false;
+
+		// These searches start again when a change reaches what they have explored, they end like a new search
+		if (_parameters.searchAlgorithm == SEARCH_BIDIRECTIONAL || (_parameters.searchAlgorithm == SEARCH_JUMP_POINT && _parameters.allowDiagonalMovements))
+			return true;
+
+		// A* finds the shortest paths with the octile heuristic of the bucket queue or without the diagonal moves, and its repairs keep them.
+		// With the landmarks it runs on the binary heap, guided by the Manhattan distance
+		return !_parameters.allowDiagonalMovements || (_parameters.openListEngine == OPEN_LIST_BUCKET_QUEUE && !_parameters.useLandmarkHeuristic);
+	}
+
+	long long Benchmark::runInitialize(GridSource* _gridSource, int _numberRun)
+	{
+		PathFinder* pathFinder = PathFinder::getInstance();
+		PreciseTimer timer;
+		long long totalTime = 0;
+
+		for (int n = 0; n < _numberRun; ++n)
+		{
+			pathFinder->reset();
+
+			long long startTime = timer.getTimeMicroSeconds();
+			pathFinder->initialize(_gridSource);
+			totalTime += timer.getTimeMicroSeconds() - startTime;
+		}
+
+		return (_numberRun > 0) ? totalTime / _numberRun : 0;
+	}
+
+	string Benchmark::toString(const string& _name, const BenchmarkReport& _report)
+	{
+		ostringstream stream;
+		stream << _name << ": " << _report.numberQuery << " queries, " << _report.numberPathFound << " paths found, "
+			<< _report.numberNodeChecked << " nodes, " << _report.totalComputeTime << "us, "
+			<< (long long)_report.getNodesPerSecond() << " nodes/s";
+		return stream.str();
+	}
+
+}
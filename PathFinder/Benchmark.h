@@ -0,0 +1,150 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <string>
+#include <vector>
+#include "GridSource.h"
+#include "PathParam.h"
+#include "PathResult.h"
+#include "ProceduralGridSource.h"
+#include "WorldPosition.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// Sum of the results of every query run by a Benchmark.
+	/// </summary>
+	struct BenchmarkReport
+	{
+		/// <summary>Number of query run.</summary>
+		int numberQuery = 0;
+
+		/// <summary>Number of query for which a path has been found.</summary>
+		int numberPathFound = 0;
+
+		/// <summary>Number of node checked by all the queries.</summary>
+		long long numberNodeChecked = 0;
+
+		/// <summary>Time in microseconds spent on the A* algorithm by all the queries.</summary>
+		long long AStarComputeTime = 0;
+
+		/// <summary>Total time in microseconds spent by all the queries.</summary>
+		long long totalComputeTime = 0;
+
+		/// <summary>Sum of the costs of the paths found, see MoveRule::COST_STRAIGHT.</summary>
+		long long totalPathCost = 0;
+
+		/// <summary>Number of node checked per second of A* algorithm.</summary>
+		double getNodesPerSecond() const;
+	};
+
+	/// <summary>
+	/// Run the same list of random queries with different parameters to compare them.
+	/// The PathFinder must be initialized before running a benchmark, ProceduralGridSource can be used to do so without the engine.
+	/// </summary>
+	class Benchmark
+	{
+
+	private:
+
+		/// <summary>Starting position of each query.</summary>
+		vector<WorldPosition> mStartPositionList;
+
+		/// <summary>Ending position of each query.</summary>
+		vector<WorldPosition> mEndPositionList;
+
+
+	public:
+
+		/// <summary>
+		/// Choose the queries in the map of the PathFinder, which must be initialized already.
+		/// </summary>
+		/// <param name="_seed">Seed used to choose the positions of the queries.</param>
+		/// <param name="_numberQuery">Number of query to run.</param>
+		Benchmark(unsigned int _seed, int _numberQuery);
+
+		/// <summary>
+		/// Run every query with findPath().
+		/// </summary>
+		/// <param name="_parameters">Parameters used for every query, the starting and ending positions are ignored.</param>
+		BenchmarkReport run(const PathParam& _parameters) const;
+
+		/// <summary>
+		/// Run every query with the binary heap and with the bucket queue, and check that the bucket queue finds paths as short.
+		/// Without the diagonal moves both engines find the shortest paths and their costs must be equal.
+		/// With them the heap is guided by the Manhattan distance and may find longer paths, the bucket queue must never.
+		/// </summary>
+		/// <param name="_parameters">Parameters used for every query, the starting and ending positions and the open list engine are ignored.</param>
+		/// <returns>Number of query whose paths do not pass the check, 0 if the engines agree.</returns>
+		int checkOpenListEngines(const PathParam& _parameters) const;
+
+		/// <summary>
+		/// Run every query with startSearch() while obstacles and columns change, and check the paths given to the callbacks.
+		/// Each frame queues a batch of changes with queueObstacle() and queueColumnsChanged() before update(), so the running searches are restarted or repaired.
+		/// A path must be walkable on the map of the frame it is given in. The searches finding the shortest paths, and the Jump Point Search
+		/// which starts again when a change reaches what it has explored, must also find a path as long as a new search on that map.
+		/// The searches run in the time given to update(), set a short time with setAllowedComputeTimePerFrame() so that they last several frames.
+		/// No other search must be running, and the worker threads must be stopped. The obstacles set by the check are removed at the end, the changed columns stay.
+		/// </summary>
+		/// <param name="_parameters">Parameters used for every query, the starting and ending positions are ignored.</param>
+		/// <param name="_gridSource">Source the PathFinder was initialized with, its columns are changed. With nullptr only the obstacles change.</param>
+		/// <param name="_seed">Seed used to choose the changes.</param>
+		/// <returns>Number of query whose paths do not pass the check, 0 if the searches follow the changes.</returns>
+		int checkMapChanges(const PathParam& _parameters, ProceduralGridSource* _gridSource, unsigned int _seed) const;
+
+		/// <summary>
+		/// Measure the startup: reset the PathFinder and initialize it with a source, several times.
+		/// The PathFinder stays initialized with the source afterwards.
+		/// </summary>
+		/// <param name="_numberRun">Number of initialization measured.</param>
+		/// <returns>Average time of PathFinder::initialize() in microseconds.</returns>
+		static long long runInitialize(GridSource* _gridSource, int _numberRun);
+
+		/// <summary>
+		/// Format a report on one line.
+		/// </summary>
+		static string toString(const string& _name, const BenchmarkReport& _report);
+
+
+	private:
+
+		/// <summary>Ids of the searches given to onSearchFinished() and not checked yet by checkMapChanges().</summary>
+		static vector<int> mFinishedSearchList;
+
+		/// <summary>
+		/// Callback of the searches started by checkMapChanges().
+		/// </summary>
+		static void onSearchFinished(int _id, PathParam* _parameters, PathResult* _result);
+
+		/// <summary>
+		/// Run one query with findPath(), the path cache cleared.
+		/// </summary>
+		/// <returns>False if the parameters were not accepted.</returns>
+		bool runQuery(int _query, const PathParam& _parameters, OpenListEngine _openListEngine, PathResult& _result) const;
+
+		/// <summary>
+		/// Cost of a path from its waypoints, the waypoints added to climb or fall cost nothing.
+		/// </summary>
+		static long long getPathCost(const PathResult& _result);
+
+		/// <summary>
+		/// Indicate if a search started again or repaired after a change finds a path as long as a new search.
+		/// </summary>
+		static bool isFollowingChanges(const PathParam& _parameters);
+	};
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "BucketQueue.h"
+
+#include <algorithm>
+
+
+namespace fournier
+{
+
+	void BucketQueue::initialize(int _numberNode, int _maximumKeySpread)
+	{
+		// The number of bucket is a power of two bigger than the spread so the bucket of a key is found with a mask
+		int numberBucket = 1;
+		while (numberBucket <= _maximumKeySpread)
+			numberBucket *= 2;
+
+		mBucketList = vector<vector<int>>(numberBucket);
+		mKeyList.assign(_numberNode);
+		mBucketMask = numberBucket - 1;
+		mCursor = -1;
+		mSize = 0;
+	}
+
+	void BucketQueue::clear()
+	{
+		for (auto it = mBucketList.begin(); it != mBucketList.end(); ++it)
+		{
+			for (auto node = (*it).begin(); node != (*it).end(); ++node)
+				mKeyList[*node] = 0;
+			(*it).clear();
+		}
+
+		mCursor = -1;
+		mSize = 0;
+	}
+
+	void BucketQueue::makeRoom(int _key)
+	{
+		// The entries left by a decrease-key give the actual key of their node, like the others
+		int firstKey = min(mCursor, _key);
+		int lastKey = max(mCursor, _key);
+		for (auto it = mBucketList.begin(); it != mBucketList.end(); ++it)
+			for (auto node = (*it).begin(); node != (*it).end(); ++node)
+				if (mKeyList[*node] != 0)
+					lastKey = max(lastKey, mKeyList[*node] - 1);
+
+		mCursor = firstKey;
+		if (lastKey - firstKey <= mBucketMask)
+			return;
+
+		// Each key of the queue must keep a bucket for itself
+		int numberBucket = (int)mBucketList.size();
+		while (numberBucket <= lastKey - firstKey)
+			numberBucket *= 2;
+
+		vector<vector<int>> bucketList(numberBucket);
+		for (auto it = mBucketList.begin(); it != mBucketList.end(); ++it)
+			for (auto node = (*it).begin(); node != (*it).end(); ++node)
+				if (mKeyList[*node] != 0)
+					bucketList[(mKeyList[*node] - 1) & (numberBucket - 1)].push_back(*node);
+
+		mBucketList.swap(bucketList);
+		mBucketMask = numberBucket - 1;
+	}
+
+}
@@ -0,0 +1,148 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __BUCKET_QUEUE_H__
+#define __BUCKET_QUEUE_H__
+
+#include <vector>
+#include "SparseArray.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// Monotone bucket queue that can be used instead of the IndexedHeap as the open list of the A* search.
+	/// The keys are integers and there is one bucket per key value, the buckets are reused in a circular way.
+	/// Push, pop and decrease-key are done in O(1) when the keys are monotone, as with a consistent heuristic:
+	/// every key given is at least the last key popped, and at most maximumKeySpread above it.
+	///
+	/// Other keys are still handled exactly, the nodes are popped in the order of their keys, but each of them costs a pass over the queue, see makeRoom().
+	/// A decrease-key does not move the node, it adds it in its new bucket and the old entry is ignored when found.
+	/// </summary>
+	class BucketQueue
+	{
+
+	private:
+
+		/// <summary>Nodes of each bucket, the key k is in the bucket k & mBucketMask.</summary>
+		vector<vector<int>> mBucketList;
+
+		/// <summary>Actual key + 1 of each node, 0 if the node is not in the queue, so only the nodes reached by a search take memory.</summary>
+		SparseArray<int> mKeyList;
+
+		/// <summary>Used to find the bucket of a key.</summary>
+		int mBucketMask;
+
+		/// <summary>Key of the bucket being emptied, the last key popped. -1 until the first push.</summary>
+		int mCursor;
+
+		/// <summary>Number of nodes in the queue.</summary>
+		int mSize;
+
+
+	public:
+
+		BucketQueue()
+			: mBucketMask(0), mCursor(-1), mSize(0)
+		{
+		}
+
+		/// <summary>
+		/// Allocate the queue, it must be called before using it. Calling it again gives back the memory used by the nodes.
+		/// </summary>
+		/// <param name="_numberNode">Number of different nodes that can be added in the queue.</param>
+		/// <param name="_maximumKeySpread">Maximum difference between the key of a pushed node and the smallest key of the queue.</param>
+		void initialize(int _numberNode, int _maximumKeySpread);
+
+		inline bool isEmpty() const { return mSize == 0; }
+
+		inline int size() const { return mSize; }
+
+		inline bool contains(int _node) const { return mKeyList[_node] != 0; }
+
+		inline void push(int _node, int _key)
+		{
+			// The first node give the starting point of the cursor, it then stays on the last key popped even when the queue gets empty
+			if (mCursor < 0)
+				mCursor = _key;
+			else if (_key < mCursor || _key > mCursor + mBucketMask)
+				makeRoom(_key);
+
+			mKeyList[_node] = _key + 1;
+			mBucketList[_key & mBucketMask].push_back(_node);
+			++mSize;
+		}
+
+		/// <summary>
+		/// Give a smaller key to a node already in the queue.
+		/// </summary>
+		inline void decreaseKey(int _node, int _key)
+		{
+			if (mKeyList[_node] == 0)
+				return;
+
+			if (_key >= mKeyList[_node] - 1)
+				return;
+			if (_key < mCursor)
+				makeRoom(_key);
+
+			// The old entry stays in its bucket and will be skipped
+			mKeyList[_node] = _key + 1;
+			mBucketList[_key & mBucketMask].push_back(_node);
+		}
+
+		/// <summary>
+		/// Remove a node with the smallest key from the queue, the last node added is returned first among nodes of equal key.
+		/// </summary>
+		/// <returns>The removed node, or -1 if the queue is empty.</returns>
+		inline int pop()
+		{
+			while (mSize > 0)
+			{
+				vector<int>& bucket = mBucketList[mCursor & mBucketMask];
+
+				while (!bucket.empty())
+				{
+					int node = bucket.back();
+					bucket.pop_back();
+
+					// Skip the entries left by a decrease-key or by a node already popped
+					if (mKeyList[node] != mCursor + 1)
+						continue;
+
+					mKeyList[node] = 0;
+					--mSize;
+					return node;
+				}
+
+				++mCursor;
+			}
+
+			return -1;
+		}
+
+		/// <summary>
+		/// Remove every node from the queue.
+		/// </summary>
+		void clear();
+
+
+	private:
+
+		/// <summary>
+		/// Move the cursor back to a key smaller than the last key popped, and add buckets if the keys of the queue do not fit in them anymore.
+		/// </summary>
+		void makeRoom(int _key);
+	};
+
+}
+
+#endif
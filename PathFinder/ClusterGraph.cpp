@@ -0,0 +1,378 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "ClusterGraph.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+
+
+namespace fournier
+{
+	/// <summary>A run of crossable cells shorter than this gives one transition in its middle, a longer one gives a transition at each end.</summary>
+	static const int MINIMUM_DOUBLE_ENTRANCE_LENGTH = 6;
+
+	ClusterGraph::ClusterGraph(const MoveRule& _moveRule, bool _allowDiagonalMovements)
+		: mMoveRule(_moveRule), mAllowDiagonalMovements(_allowDiagonalMovements)
+	{
+		mClusterList.resize(getNumberClusterX() * getNumberClusterY());
+
+		// Every cluster is built with the first update
+		for (int c = 0; c < (int)mClusterList.size(); ++c)
+			mDirtyClusterList.push_back(c);
+	}
+
+	void ClusterGraph::setCellsChanged(int _x, int _y, int _width, int _depth)
+	{
+		// A cell on the border of a cluster also changes the transitions of the neighbour cluster
+		int firstX = max(0, _x - 1) / PATHFINDER_CLUSTER_SIZE;
+		int firstY = max(0, _y - 1) / PATHFINDER_CLUSTER_SIZE;
+		int lastX = min(NavigationGrid::getSizeX() - 1, _x + _width) / PATHFINDER_CLUSTER_SIZE;
+		int lastY = min(NavigationGrid::getSizeY() - 1, _y + _depth) / PATHFINDER_CLUSTER_SIZE;
+
+		for (int clusterY = firstY; clusterY <= lastY; ++clusterY)
+		{
+			for (int clusterX = firstX; clusterX <= lastX; ++clusterX)
+			{
+				int c = clusterX + clusterY * getNumberClusterX();
+				if (mClusterList[c].isDirty)
+					continue;
+
+				mClusterList[c].isDirty = true;
+				mDirtyClusterList.push_back(c);
+			}
+		}
+	}
+
+	void ClusterGraph::update(const NavigationGrid& _grid)
+	{
+		for (auto it = mDirtyClusterList.begin(); it != mDirtyClusterList.end(); ++it)
+			buildCluster(_grid, *it);
+		mDirtyClusterList.clear();
+	}
+
+	size_t ClusterGraph::getMemorySize() const
+	{
+		size_t memorySize = mClusterList.capacity() * sizeof(Cluster);
+		for (auto it = mClusterList.begin(); it != mClusterList.end(); ++it)
+		{
+			memorySize += (*it).nodeCellList.capacity() * sizeof(int);
+			memorySize += (*it).costList.capacity() * sizeof(int);
+			memorySize += (*it).transitionList.capacity() * sizeof(Transition);
+		}
+		return memorySize;
+	}
+
+	int ClusterGraph::findNode(int _cluster, int _cellIndex) const
+	{
+		const vector<int>& nodeCellList = mClusterList[_cluster].nodeCellList;
+		for (int n = 0; n < (int)nodeCellList.size(); ++n)
+		{
+			if (nodeCellList[n] == _cellIndex)
+				return n;
+		}
+		return -1;
+	}
+
+	int ClusterGraph::computeNodeCosts(const NavigationGrid& _grid, int _cluster, int _cellIndex, bool _isReversed, vector<int>& _costList) const
+	{
+		vector<int> cellCostList, parentList;
+		int numberCellChecked = searchInCluster(_grid, _cluster, _cellIndex, -1, _isReversed, cellCostList, parentList);
+
+		int x, y, width, depth;
+		getClusterBounds(_cluster, x, y, width, depth);
+
+		const vector<int>& nodeCellList = mClusterList[_cluster].nodeCellList;
+		_costList.resize(nodeCellList.size());
+		for (int n = 0; n < (int)nodeCellList.size(); ++n)
+			_costList[n] = cellCostList[(NavigationGrid::getX(nodeCellList[n]) - x) + (NavigationGrid::getY(nodeCellList[n]) - y) * width];
+
+		return numberCellChecked;
+	}
+
+	int ClusterGraph::computeCost(const NavigationGrid& _grid, int _cluster, int _fromCell, int _toCell) const
+	{
+		vector<int> costList, parentList;
+		searchInCluster(_grid, _cluster, _fromCell, _toCell, false, costList, parentList);
+
+		int x, y, width, depth;
+		getClusterBounds(_cluster, x, y, width, depth);
+		return costList[(NavigationGrid::getX(_toCell) - x) + (NavigationGrid::getY(_toCell) - y) * width];
+	}
+
+	int ClusterGraph::findPath(const NavigationGrid& _grid, int _cluster, int _fromCell, int _toCell, vector<int>& _cellList) const
+	{
+		vector<int> costList, parentList;
+		int numberCellChecked = searchInCluster(_grid, _cluster, _fromCell, _toCell, false, costList, parentList);
+
+		int x, y, width, depth;
+		getClusterBounds(_cluster, x, y, width, depth);
+
+		int localIndex = (NavigationGrid::getX(_toCell) - x) + (NavigationGrid::getY(_toCell) - y) * width;
+		if (costList[localIndex] == -1)
+			return numberCellChecked;
+
+		// Follow the parents back to the first cell, then put the cells in the order of the path
+		size_t firstCell = _cellList.size();
+		for (; parentList[localIndex] != -1; localIndex = parentList[localIndex])
+			_cellList.push_back(NavigationGrid::index(x + localIndex % width, y + localIndex / width));
+		reverse(_cellList.begin() + firstCell, _cellList.end());
+
+		return numberCellChecked;
+	}
+
+	int ClusterGraph::searchInCluster(const NavigationGrid& _grid, int _cluster, int _cellIndex, int _endCell, bool _isReversed, vector<int>& _costList, vector<int>& _parentList) const
+	{
+		int x, y, width, depth;
+		getClusterBounds(_cluster, x, y, width, depth);
+
+		_costList.assign(width * depth, -1);
+		_parentList.assign(width * depth, -1);
+
+		// With an end cell the search is an A* guided by the octile distance, or the Manhattan distance without diagonal moves
+		int endX = (_endCell != -1) ? NavigationGrid::getX(_endCell) - x : 0;
+		int endY = (_endCell != -1) ? NavigationGrid::getY(_endCell) - y : 0;
+		auto heuristic = [&](int _localX, int _localY)
+		{
+			if (_endCell == -1)
+				return 0;
+			int distanceX = abs(_localX - endX);
+			int distanceY = abs(_localY - endY);
+			int diagonal = mAllowDiagonalMovements ? min(distanceX, distanceY) : 0;
+			return diagonal * MoveRule::COST_DIAGONAL + (distanceX + distanceY - 2 * diagonal) * MoveRule::COST_STRAIGHT;
+		};
+
+		// The open list holds (cost + heuristic, local index), a cell already reached with a smaller cost is skipped when popped
+		priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> openList;
+
+		int startIndex = (NavigationGrid::getX(_cellIndex) - x) + (NavigationGrid::getY(_cellIndex) - y) * width;
+		_costList[startIndex] = 0;
+		openList.push(make_pair(heuristic(startIndex % width, startIndex / width), startIndex));
+
+		int directionStep = mAllowDiagonalMovements ? 1 : 2;
+		int numberCellChecked = 0;
+
+		while (!openList.empty())
+		{
+			int localIndex = openList.top().second;
+			int localX = localIndex % width;
+			int localY = localIndex / width;
+			int cost = openList.top().first - heuristic(localX, localY);
+			openList.pop();
+
+			if (cost > _costList[localIndex])
+				continue;
+
+			++numberCellChecked;
+
+			int cellIndex = NavigationGrid::index(x + localX, y + localY);
+			if (cellIndex == _endCell)
+				break;
+
+			for (int direction = 0; direction < 8; direction += directionStep)
+			{
+				int neighbourX = localX + NavigationGrid::NEIGHBOUR_X[direction];
+				int neighbourY = localY + NavigationGrid::NEIGHBOUR_Y[direction];
+				if (neighbourX < 0 || neighbourX >= width || neighbourY < 0 || neighbourY >= depth)
+					continue;
+
+				int neighbourIndex = NavigationGrid::index(x + neighbourX, y + neighbourY);
+				bool canMove = _isReversed ? mMoveRule.canMove(_grid, neighbourIndex, cellIndex) : mMoveRule.canMove(_grid, cellIndex, neighbourIndex);
+				if (!canMove)
+					continue;
+
+				int neighbourLocalIndex = neighbourX + neighbourY * width;
+				int newCost = cost + ((direction & 1) ? MoveRule::COST_DIAGONAL : MoveRule::COST_STRAIGHT);
+				if (_costList[neighbourLocalIndex] == -1 || newCost < _costList[neighbourLocalIndex])
+				{
+					_costList[neighbourLocalIndex] = newCost;
+					_parentList[neighbourLocalIndex] = localIndex;
+					openList.push(make_pair(newCost + heuristic(neighbourX, neighbourY), neighbourLocalIndex));
+				}
+			}
+		}
+
+		return numberCellChecked;
+	}
+
+	void ClusterGraph::computeTransitions(const NavigationGrid& _grid, int _cluster, int _side, vector<Transition>& _transitionList) const
+	{
+		if (getNeighbourCluster(_cluster, _side * 2) == -1)
+			return;
+
+		int x, y, width, depth;
+		getClusterBounds(_cluster, x, y, width, depth);
+
+		// First border cell of the cluster, direction along the border and direction to the neighbour cluster
+		int borderX = (_side == 0) ? x + width - 1 : x;
+		int borderY = (_side == 1) ? y + depth - 1 : y;
+		int alongX = (_side & 1) ? 1 : 0;
+		int alongY = (_side & 1) ? 0 : 1;
+		int acrossX = NavigationGrid::NEIGHBOUR_X[_side * 2];
+		int acrossY = NavigationGrid::NEIGHBOUR_Y[_side * 2];
+		int length = (_side & 1) ? width : depth;
+
+		auto borderCell = [&](int _k) { return NavigationGrid::index(borderX + _k * alongX, borderY + _k * alongY); };
+		auto acrossCell = [&](int _k) { return NavigationGrid::index(borderX + acrossX + _k * alongX, borderY + acrossY + _k * alongY); };
+
+		// Cell reached when crossing the border from each border cell, the straight move is preferred, -1 if the border cannot be crossed
+		vector<int> targetList(length, -1);
+		for (int k = 0; k < length; ++k)
+		{
+			int fromCell = borderCell(k);
+			if (!mMoveRule.isWalkable(_grid.cell(fromCell)))
+				continue;
+
+			for (int shift = 0; shift < (mAllowDiagonalMovements ? 3 : 1) && targetList[k] == -1; ++shift)
+			{
+				int offset = (shift == 0) ? 0 : ((shift == 1) ? -1 : 1);
+				if (k + offset < 0 || k + offset >= length)
+					continue;
+
+				int toCell = acrossCell(k + offset);
+				if (mMoveRule.canMove(_grid, fromCell, toCell))
+					targetList[k] = toCell;
+			}
+		}
+
+		// Two straight crossings are in the same entrance when the search can walk both ways between them, on each side of the border
+		auto isSameEntrance = [&](int _k)
+		{
+			if (targetList[_k] != acrossCell(_k) || targetList[_k + 1] != acrossCell(_k + 1))
+				return false;
+
+			return mMoveRule.canMove(_grid, borderCell(_k), borderCell(_k + 1)) && mMoveRule.canMove(_grid, borderCell(_k + 1), borderCell(_k)) &&
+				mMoveRule.canMove(_grid, acrossCell(_k), acrossCell(_k + 1)) && mMoveRule.canMove(_grid, acrossCell(_k + 1), acrossCell(_k));
+		};
+
+		auto addTransition = [&](int _k)
+		{
+			Transition transition;
+			transition.fromCell = borderCell(_k);
+			transition.toCell = targetList[_k];
+			transition.cost = (transition.toCell == acrossCell(_k)) ? MoveRule::COST_STRAIGHT : MoveRule::COST_DIAGONAL;
+			_transitionList.push_back(transition);
+		};
+
+		// Each run of crossings is an entrance
+		for (int k = 0; k < length; ++k)
+		{
+			if (targetList[k] == -1)
+				continue;
+
+			int first = k;
+			while (k + 1 < length && isSameEntrance(k))
+				++k;
+
+			if (k - first + 1 < MINIMUM_DOUBLE_ENTRANCE_LENGTH)
+			{
+				addTransition((first + k) / 2);
+			}
+			else
+			{
+				addTransition(first);
+				addTransition(k);
+			}
+		}
+	}
+
+	void ClusterGraph::computeCornerTransition(const NavigationGrid& _grid, int _cluster, int _direction, vector<Transition>& _transitionList) const
+	{
+		if (!mAllowDiagonalMovements || getNeighbourCluster(_cluster, _direction) == -1)
+			return;
+
+		int x, y, width, depth;
+		getClusterBounds(_cluster, x, y, width, depth);
+
+		int cornerX = (NavigationGrid::NEIGHBOUR_X[_direction] > 0) ? x + width - 1 : x;
+		int cornerY = (NavigationGrid::NEIGHBOUR_Y[_direction] > 0) ? y + depth - 1 : y;
+
+		Transition transition;
+		transition.fromCell = NavigationGrid::index(cornerX, cornerY);
+		transition.toCell = NavigationGrid::index(cornerX + NavigationGrid::NEIGHBOUR_X[_direction], cornerY + NavigationGrid::NEIGHBOUR_Y[_direction]);
+		transition.cost = MoveRule::COST_DIAGONAL;
+
+		if (mMoveRule.isWalkable(_grid.cell(transition.fromCell)) && mMoveRule.canMove(_grid, transition.fromCell, transition.toCell))
+			_transitionList.push_back(transition);
+	}
+
+	void ClusterGraph::buildCluster(const NavigationGrid& _grid, int _cluster)
+	{
+		Cluster& cluster = mClusterList[_cluster];
+		cluster.nodeCellList.clear();
+		cluster.transitionList.clear();
+
+		auto addNode = [&](int _cellIndex)
+		{
+			if (find(cluster.nodeCellList.begin(), cluster.nodeCellList.end(), _cellIndex) == cluster.nodeCellList.end())
+				cluster.nodeCellList.push_back(_cellIndex);
+		};
+
+		// The transitions leaving the cluster start from its nodes, the ones coming from the neighbours end on its nodes
+		// The even directions cross a side of the cluster, the odd ones a corner
+		vector<Transition> incomingList;
+		for (int direction = 0; direction < 8; ++direction)
+		{
+			int neighbour = getNeighbourCluster(_cluster, direction);
+			int oppositeDirection = (direction + 4) & 7;
+
+			if (direction & 1)
+			{
+				computeCornerTransition(_grid, _cluster, direction, cluster.transitionList);
+				if (neighbour != -1)
+					computeCornerTransition(_grid, neighbour, oppositeDirection, incomingList);
+			}
+			else
+			{
+				computeTransitions(_grid, _cluster, direction / 2, cluster.transitionList);
+				if (neighbour != -1)
+					computeTransitions(_grid, neighbour, oppositeDirection / 2, incomingList);
+			}
+		}
+
+		for (auto it = cluster.transitionList.begin(); it != cluster.transitionList.end(); ++it)
+			addNode((*it).fromCell);
+		for (auto it = incomingList.begin(); it != incomingList.end(); ++it)
+			addNode((*it).toCell);
+
+		// Cost between each pair of nodes
+		int numberNode = (int)cluster.nodeCellList.size();
+		cluster.costList.resize(numberNode * numberNode);
+
+		vector<int> nodeCostList;
+		for (int n = 0; n < numberNode; ++n)
+		{
+			computeNodeCosts(_grid, _cluster, cluster.nodeCellList[n], false, nodeCostList);
+			copy(nodeCostList.begin(), nodeCostList.end(), cluster.costList.begin() + n * numberNode);
+		}
+
+		cluster.isDirty = false;
+	}
+
+	void ClusterGraph::getClusterBounds(int _cluster, int& _x, int& _y, int& _width, int& _depth)
+	{
+		_x = (_cluster % getNumberClusterX()) * PATHFINDER_CLUSTER_SIZE;
+		_y = (_cluster / getNumberClusterX()) * PATHFINDER_CLUSTER_SIZE;
+		_width = min((int)PATHFINDER_CLUSTER_SIZE, NavigationGrid::getSizeX() - _x);
+		_depth = min((int)PATHFINDER_CLUSTER_SIZE, NavigationGrid::getSizeY() - _y);
+	}
+
+	int ClusterGraph::getNeighbourCluster(int _cluster, int _direction)
+	{
+		int clusterX = _cluster % getNumberClusterX() + NavigationGrid::NEIGHBOUR_X[_direction];
+		int clusterY = _cluster / getNumberClusterX() + NavigationGrid::NEIGHBOUR_Y[_direction];
+		if (clusterX < 0 || clusterX >= getNumberClusterX() || clusterY < 0 || clusterY >= getNumberClusterY())
+			return -1;
+		return clusterX + clusterY * getNumberClusterX();
+	}
+
+}
@@ -0,0 +1,181 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __CLUSTER_GRAPH_H__
+#define __CLUSTER_GRAPH_H__
+
+#include <vector>
+#include "PathFinderConfig.h"
+#include "NavigationGrid.h"
+#include "MoveRule.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// Abstract graph used by the hierarchical search (HPA*) of one MoveRule.
+	/// The map is cut in square clusters of PATHFINDER_CLUSTER_SIZE cells, the chunks of the world.
+	/// Along the border of two clusters, each run of cells where the border can be crossed gives one or two transitions:
+	/// moves from a cell of a cluster to a cell of the other one.
+	/// With the diagonal moves, the corner of two clusters can also be crossed. The cells at the ends of the transitions are the nodes of the graph.
+	/// Each cluster keeps the cost of the shortest path between every pair of its nodes, staying inside the cluster.
+	///
+	/// A cluster is built again, with its neighbours when a border cell changed, only when a cell inside it changes.
+	/// </summary>
+	class ClusterGraph
+	{
+
+	public:
+
+		/// <summary>
+		/// Move leaving a cluster.
+		/// </summary>
+		struct Transition
+		{
+			int fromCell;
+			int toCell;
+			int cost;
+		};
+
+		/// <summary>
+		/// Nodes and edges of one cluster.
+		/// </summary>
+		struct Cluster
+		{
+			/// <summary>Index of the cell of each node of the cluster.</summary>
+			vector<int> nodeCellList;
+
+			/// <summary>Cost of the shortest path from the node i to the node j at i * number of nodes + j, -1 if there is no path inside the cluster.</summary>
+			vector<int> costList;
+
+			/// <summary>Transitions from the nodes of this cluster to the nodes of the neighbour clusters.</summary>
+			vector<Transition> transitionList;
+
+			bool isDirty = true;
+		};
+
+		/// <summary>Number of clusters on the X axis of the map.</summary>
+		inline static int getNumberClusterX() { return (NavigationGrid::getSizeX() + PATHFINDER_CLUSTER_SIZE - 1) / PATHFINDER_CLUSTER_SIZE; }
+
+		/// <summary>Number of clusters on the Y axis of the map.</summary>
+		inline static int getNumberClusterY() { return (NavigationGrid::getSizeY() + PATHFINDER_CLUSTER_SIZE - 1) / PATHFINDER_CLUSTER_SIZE; }
+
+
+	private:
+
+		MoveRule mMoveRule;
+
+		bool mAllowDiagonalMovements;
+
+		vector<Cluster> mClusterList;
+
+		/// <summary>Index of the clusters to build again.</summary>
+		vector<int> mDirtyClusterList;
+
+
+	public:
+
+		ClusterGraph(const MoveRule& _moveRule, bool _allowDiagonalMovements);
+
+		inline const MoveRule& getMoveRule() const { return mMoveRule; }
+
+		inline bool allowsDiagonalMovements() const { return mAllowDiagonalMovements; }
+
+		inline bool isDirty() const { return !mDirtyClusterList.empty(); }
+
+		/// <summary>
+		/// Mark the clusters touched by a rectangle of changed cells to be built again.
+		/// </summary>
+		void setCellsChanged(int _x, int _y, int _width, int _depth);
+
+		/// <summary>
+		/// Build the dirty clusters again.
+		/// </summary>
+		void update(const NavigationGrid& _grid);
+
+		/// <summary>
+		/// Number of bytes used by the graph.
+		/// </summary>
+		size_t getMemorySize() const;
+
+		inline static int getCluster(int _cellIndex)
+		{
+			return NavigationGrid::getX(_cellIndex) / PATHFINDER_CLUSTER_SIZE + (NavigationGrid::getY(_cellIndex) / PATHFINDER_CLUSTER_SIZE) * getNumberClusterX();
+		}
+
+		inline const Cluster& cluster(int _cluster) const { return mClusterList[_cluster]; }
+
+		/// <summary>
+		/// Find the node of a cluster on a cell.
+		/// </summary>
+		/// <returns>The index of the node in the cluster, or -1 if the cell is not a node.</returns>
+		int findNode(int _cluster, int _cellIndex) const;
+
+		/// <summary>
+		/// Compute the cost of the shortest paths inside a cluster from a cell to every cell of the cluster, or from every cell to a cell if reversed.
+		/// </summary>
+		/// <param name="_cellIndex">Cell the paths start from, or end at if reversed.</param>
+		/// <param name="_isReversed">Follow the moves backward.</param>
+		/// <param name="_costList">Receives the cost of the path of each node of the cluster, -1 if there is none.</param>
+		/// <returns>Number of cells checked.</returns>
+		int computeNodeCosts(const NavigationGrid& _grid, int _cluster, int _cellIndex, bool _isReversed, vector<int>& _costList) const;
+
+		/// <summary>
+		/// Compute the cost of the shortest path inside a cluster between two of its cells.
+		/// </summary>
+		/// <returns>The cost of the path, or -1 if there is none.</returns>
+		int computeCost(const NavigationGrid& _grid, int _cluster, int _fromCell, int _toCell) const;
+
+		/// <summary>
+		/// Find the shortest path inside a cluster between two of its cells.
+		/// </summary>
+		/// <param name="_cellList">Receives the cells of the path after _fromCell, up to _toCell.</param>
+		/// <returns>Number of cells checked, _cellList is left unchanged if there is no path.</returns>
+		int findPath(const NavigationGrid& _grid, int _cluster, int _fromCell, int _toCell, vector<int>& _cellList) const;
+
+
+	private:
+
+		/// <summary>
+		/// Dijkstra search restricted to the cells of a cluster, or A* search when it has an end cell.
+		/// </summary>
+		/// <param name="_endCell">Cell where the search stops, -1 to reach every cell.</param>
+		/// <param name="_costList">Receives the cost of each cell of the cluster, by local index.</param>
+		/// <param name="_parentList">Receives the local index of the parent of each cell of the cluster.</param>
+		/// <returns>Number of cells checked.</returns>
+		int searchInCluster(const NavigationGrid& _grid, int _cluster, int _cellIndex, int _endCell, bool _isReversed, vector<int>& _costList, vector<int>& _parentList) const;
+
+		/// <summary>
+		/// Find the transitions leaving a cluster on one of its sides.
+		/// </summary>
+		/// <param name="_side">0 to 3 for +X, +Y, -X and -Y.</param>
+		void computeTransitions(const NavigationGrid& _grid, int _cluster, int _side, vector<Transition>& _transitionList) const;
+
+		/// <summary>
+		/// Find the diagonal transition leaving a cluster by one of its corners.
+		/// </summary>
+		/// <param name="_direction">Index of a diagonal direction, see NavigationGrid::NEIGHBOUR_X.</param>
+		void computeCornerTransition(const NavigationGrid& _grid, int _cluster, int _direction, vector<Transition>& _transitionList) const;
+
+		void buildCluster(const NavigationGrid& _grid, int _cluster);
+
+		static void getClusterBounds(int _cluster, int& _x, int& _y, int& _width, int& _depth);
+
+		/// <summary>
+		/// Get the cluster next to a cluster in one direction, -1 outside of the map.
+		/// </summary>
+		/// <param name="_direction">Index of the direction, see NavigationGrid::NEIGHBOUR_X.</param>
+		static int getNeighbourCluster(int _cluster, int _direction);
+	};
+
+}
+
+#endif
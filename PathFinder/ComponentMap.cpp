@@ -0,0 +1,216 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "ComponentMap.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+
+namespace fournier
+{
+	ComponentMap::ComponentMap(const MoveRule& _moveRule, bool _allowDiagonalMovements)
+		: mMoveRule(_moveRule), mAllowDiagonalMovements(_allowDiagonalMovements), mParentList(nullptr), mIsDirty(true)
+	{
+	}
+
+	void ComponentMap::build(const NavigationGrid& _grid)
+	{
+		mOwnedParentList.resize(NavigationGrid::getNumberIndex());
+		mParentList = mOwnedParentList.data();
+		for (int n = 0; n < NavigationGrid::getNumberIndex(); ++n)
+			mParentList[n] = n;
+
+		// Each link is checked once, from the cell before it in the order of the indexes
+		int directionStep = mAllowDiagonalMovements ? 1 : 2;
+		for (int y = 0; y < NavigationGrid::getSizeY(); ++y)
+		{
+			for (int x = 0; x < NavigationGrid::getSizeX(); ++x)
+			{
+				int actualIndex = NavigationGrid::index(x, y);
+				if (!mMoveRule.isWalkable(_grid.cell(actualIndex)))
+					continue;
+
+				for (int direction = 0; direction < 4; direction += directionStep)
+				{
+					int neighbourX = x + NavigationGrid::NEIGHBOUR_X[direction];
+					int neighbourY = y + NavigationGrid::NEIGHBOUR_Y[direction];
+					if (!NavigationGrid::isInRange(neighbourX, neighbourY))
+						continue;
+
+					int neighbourIndex = NavigationGrid::index(neighbourX, neighbourY);
+					if (isLinked(_grid, actualIndex, neighbourIndex))
+						merge(actualIndex, neighbourIndex);
+				}
+			}
+		}
+
+		mIsDirty = false;
+	}
+
+	void ComponentMap::attach(int* _componentList)
+	{
+		// The component of a cell is the root of its tree, so the list is already a union-find structure
+		mOwnedParentList.clear();
+		mOwnedParentList.shrink_to_fit();
+		mParentList = _componentList;
+		mIsDirty = false;
+	}
+
+	void ComponentMap::setCellsChanged(const NavigationGrid& _grid, int _x, int _y, int _width, int _depth)
+	{
+		if (mIsDirty)
+			return;
+
+		// The links changed are inside the rectangle and its border of one cell
+		int firstX = max(0, _x - 1);
+		int firstY = max(0, _y - 1);
+		int lastX = min(NavigationGrid::getSizeX() - 1, _x + _width);
+		int lastY = min(NavigationGrid::getSizeY() - 1, _y + _depth);
+		int width = lastX - firstX + 1;
+		int depth = lastY - firstY + 1;
+		int directionStep = mAllowDiagonalMovements ? 1 : 2;
+
+		// Group the walkable cells of the block linked together without leaving it
+		vector<int> groupList(width * depth, -1);
+		vector<int> stack;
+		int numberGroup = 0;
+		for (int n = 0; n < width * depth; ++n)
+		{
+			if (groupList[n] != -1 || !mMoveRule.isWalkable(_grid.cell(NavigationGrid::index(firstX + n % width, firstY + n / width))))
+				continue;
+
+			groupList[n] = numberGroup;
+			stack.push_back(n);
+			while (!stack.empty())
+			{
+				int local = stack.back();
+				stack.pop_back();
+
+				int x = firstX + local % width;
+				int y = firstY + local / width;
+				for (int direction = 0; direction < 8; direction += directionStep)
+				{
+					int neighbourX = x + NavigationGrid::NEIGHBOUR_X[direction];
+					int neighbourY = y + NavigationGrid::NEIGHBOUR_Y[direction];
+					if (neighbourX < firstX || neighbourX > lastX || neighbourY < firstY || neighbourY > lastY)
+						continue;
+
+					int neighbourLocal = (neighbourX - firstX) + (neighbourY - firstY) * width;
+					if (groupList[neighbourLocal] == -1 && isLinked(_grid, NavigationGrid::index(x, y), NavigationGrid::index(neighbourX, neighbourY)))
+					{
+						groupList[neighbourLocal] = numberGroup;
+						stack.push_back(neighbourLocal);
+					}
+				}
+			}
+			++numberGroup;
+		}
+
+		// A path of a component crossing the block can go around the changed cells if its cells in the block are still in one group
+		// Otherwise the component may be split and everything is built again on the next use
+		unordered_map<int, int> groupOfRootList;
+		for (int n = 0; n < width * depth; ++n)
+		{
+			if (groupList[n] == -1)
+				continue;
+
+			int root = findRoot(NavigationGrid::index(firstX + n % width, firstY + n / width));
+			auto it = groupOfRootList.find(root);
+			if (it == groupOfRootList.end())
+				groupOfRootList[root] = groupList[n];
+			else if (it->second != groupList[n])
+			{
+				mIsDirty = true;
+				return;
+			}
+		}
+
+		// The new links merge their components
+		for (int y = firstY; y <= lastY; ++y)
+		{
+			for (int x = firstX; x <= lastX; ++x)
+			{
+				int actualIndex = NavigationGrid::index(x, y);
+				for (int direction = 0; direction < 4; direction += directionStep)
+				{
+					int neighbourX = x + NavigationGrid::NEIGHBOUR_X[direction];
+					int neighbourY = y + NavigationGrid::NEIGHBOUR_Y[direction];
+					if (neighbourX < firstX || neighbourX > lastX || neighbourY < firstY || neighbourY > lastY)
+						continue;
+
+					int neighbourIndex = NavigationGrid::index(neighbourX, neighbourY);
+					if (isLinked(_grid, actualIndex, neighbourIndex))
+						merge(actualIndex, neighbourIndex);
+				}
+			}
+		}
+	}
+
+	bool ComponentMap::canReach(const NavigationGrid& _grid, int _startIndex, int _endIndex)
+	{
+		if (_startIndex == _endIndex)
+			return true;
+
+		if (!mMoveRule.isWalkable(_grid.cell(_endIndex)))
+			return false;
+
+		int endRoot = findRoot(_endIndex);
+		if (mMoveRule.isWalkable(_grid.cell(_startIndex)))
+			return findRoot(_startIndex) == endRoot;
+
+		// A search can start on a cell that is not walkable, the path then goes through one of the cells it can move to
+		int x = NavigationGrid::getX(_startIndex);
+		int y = NavigationGrid::getY(_startIndex);
+		int directionStep = mAllowDiagonalMovements ? 1 : 2;
+		for (int direction = 0; direction < 8; direction += directionStep)
+		{
+			int neighbourX = x + NavigationGrid::NEIGHBOUR_X[direction];
+			int neighbourY = y + NavigationGrid::NEIGHBOUR_Y[direction];
+			if (!NavigationGrid::isInRange(neighbourX, neighbourY))
+				continue;
+
+			int neighbourIndex = NavigationGrid::index(neighbourX, neighbourY);
+			if (mMoveRule.canMove(_grid, _startIndex, neighbourIndex) && findRoot(neighbourIndex) == endRoot)
+				return true;
+		}
+		return false;
+	}
+
+	int ComponentMap::findRoot(int _index)
+	{
+		while (mParentList[_index] != _index)
+		{
+			mParentList[_index] = mParentList[mParentList[_index]];
+			_index = mParentList[_index];
+		}
+		return _index;
+	}
+
+	void ComponentMap::merge(int _firstIndex, int _secondIndex)
+	{
+		int firstRoot = findRoot(_firstIndex);
+		int secondRoot = findRoot(_secondIndex);
+		if (firstRoot != secondRoot)
+			mParentList[max(firstRoot, secondRoot)] = min(firstRoot, secondRoot);
+	}
+
+	bool ComponentMap::isLinked(const NavigationGrid& _grid, int _firstIndex, int _secondIndex) const
+	{
+		if (!mMoveRule.isWalkable(_grid.cell(_firstIndex)) || !mMoveRule.isWalkable(_grid.cell(_secondIndex)))
+			return false;
+
+		int heightDifference = _grid.getHeight(_secondIndex) - _grid.getHeight(_firstIndex);
+		bool canMoveForward = heightDifference <= mMoveRule.maximumFallHeight && -heightDifference <= mMoveRule.maximumJumpHeight;
+		bool canMoveBackward = -heightDifference <= mMoveRule.maximumFallHeight && heightDifference <= mMoveRule.maximumJumpHeight;
+		return canMoveForward || canMoveBackward;
+	}
+
+}
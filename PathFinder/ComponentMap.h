@@ -0,0 +1,110 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __COMPONENT_MAP_H__
+#define __COMPONENT_MAP_H__
+
+#include <vector>
+#include "PathFinderConfig.h"
+#include "NavigationGrid.h"
+#include "MoveRule.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// Connected components of the walkable cells of one MoveRule, used to reject a search whose end cannot be reached without running it.
+	/// Two neighbour cells are linked when a move is possible between them in at least one way, so two cells in different components
+	/// can never reach each other. With the same maximum jump and fall heights the moves go both ways and the components are exact.
+	///
+	/// The components are kept in a union-find structure. A change that opens new moves only merges components.
+	/// A change that may split a component, when the cells of a component around it are not linked together any more, marks the map to be built again.
+	/// </summary>
+	class ComponentMap
+	{
+
+	private:
+
+		MoveRule mMoveRule;
+
+		bool mAllowDiagonalMovements;
+
+		/// <summary>Parent of each cell in the union-find structure, a cell is the root of its component when it is its own parent.</summary>
+		int* mParentList;
+
+		/// <summary>Parents allocated by build(), empty when the components are the ones of a snapshot.</summary>
+		vector<int> mOwnedParentList;
+
+		/// <summary>The map has changed in a way that can split a component since the last build.</summary>
+		bool mIsDirty;
+
+
+	public:
+
+		ComponentMap(const MoveRule& _moveRule, bool _allowDiagonalMovements);
+
+		inline const MoveRule& getMoveRule() const { return mMoveRule; }
+
+		inline bool allowsDiagonalMovements() const { return mAllowDiagonalMovements; }
+
+		inline bool isDirty() const { return mIsDirty; }
+
+		/// <summary>
+		/// Find the components of every cell, in O(cells).
+		/// </summary>
+		void build(const NavigationGrid& _grid);
+
+		/// <summary>
+		/// Use components stored elsewhere instead of finding them, see NavigationSnapshot. They are not copied and must stay valid as long as the map.
+		/// </summary>
+		/// <param name="_componentList">Component of each cell, the index of a cell of the component, the same for all its cells.</param>
+		void attach(int* _componentList);
+
+		/// <summary>
+		/// Update the components after a rectangle of cells has changed, the grid must already hold the new cells.
+		/// </summary>
+		void setCellsChanged(const NavigationGrid& _grid, int _x, int _y, int _width, int _depth);
+
+		/// <summary>
+		/// Indicate if a path can exist between two cells. False means that the end can never be reached, true that it may be.
+		/// The start cell does not have to be walkable, like the start of a search.
+		/// </summary>
+		bool canReach(const NavigationGrid& _grid, int _startIndex, int _endIndex);
+
+		/// <summary>
+		/// Component of a cell, the index of one of its cells. The map must have been built.
+		/// </summary>
+		inline int getComponent(int _index) { return findRoot(_index); }
+
+		/// <summary>
+		/// Number of bytes allocated for the map, the components of a snapshot are not counted.
+		/// </summary>
+		inline size_t getMemorySize() const { return mOwnedParentList.capacity() * sizeof(int); }
+
+
+	private:
+
+		/// <summary>
+		/// Get the root of the component of a cell, the path to it is shortened on the way.
+		/// </summary>
+		int findRoot(int _index);
+
+		void merge(int _firstIndex, int _secondIndex);
+
+		/// <summary>
+		/// Indicate if two neighbour cells are linked by a move in at least one way, both must be walkable.
+		/// </summary>
+		bool isLinked(const NavigationGrid& _grid, int _firstIndex, int _secondIndex) const;
+	};
+
+}
+
+#endif
@@ -0,0 +1,186 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "FlowField.h"
+
+#include <algorithm>
+
+
+namespace fournier
+{
+	FlowField::FlowField(const MoveRule& _moveRule, bool _allowDiagonalMovements, int _goalIndex)
+		: mMoveRule(_moveRule), mAllowDiagonalMovements(_allowDiagonalMovements), mGoalIndex(-1)
+	{
+		setGoal(_goalIndex);
+	}
+
+	void FlowField::setGoal(int _goalIndex)
+	{
+		if (_goalIndex == mGoalIndex)
+			return;
+
+		mGoalIndex = _goalIndex;
+
+		mDistanceList.assign(NavigationGrid::getNumberIndex(), (int)INFINITE_DISTANCE);
+		mDirectionList.assign(NavigationGrid::getNumberIndex(), (unsigned char)NO_DIRECTION);
+		mOpenList = priority_queue<OpenEntry, vector<OpenEntry>, greater<OpenEntry>>();
+		mChangedCellList.clear();
+
+		mDistanceList[mGoalIndex] = 0;
+		mOpenList.push(OpenEntry{ 0, mGoalIndex });
+	}
+
+	void FlowField::setCellsChanged(int _x, int _y, int _width, int _depth)
+	{
+		for (int y = _y; y < _y + _depth; ++y)
+			for (int x = _x; x < _x + _width; ++x)
+				mChangedCellList.push_back(NavigationGrid::index(x, y));
+	}
+
+	bool FlowField::getNextStep(const NavigationGrid& _grid, int _index, int& _nextIndex)
+	{
+		if (!mChangedCellList.empty())
+			repair(_grid);
+
+		// The cost of the cell is the smallest one when no cell of the open list can give it a lower one
+		while (!mOpenList.empty() && mOpenList.top().distance < mDistanceList[_index])
+		{
+			OpenEntry entry = mOpenList.top();
+			mOpenList.pop();
+
+			if (entry.distance != mDistanceList[entry.index])
+				continue;
+
+			updatePredecessors(_grid, entry.index);
+		}
+
+		if (mDistanceList[_index] >= INFINITE_DISTANCE)
+			return false;
+
+		if (_index == mGoalIndex)
+		{
+			_nextIndex = _index;
+			return true;
+		}
+
+		int direction = mDirectionList[_index];
+		_nextIndex = NavigationGrid::index(NavigationGrid::getX(_index) + NavigationGrid::NEIGHBOUR_X[direction], NavigationGrid::getY(_index) + NavigationGrid::NEIGHBOUR_Y[direction]);
+		return true;
+	}
+
+	size_t FlowField::getMemorySize() const
+	{
+		return mDistanceList.capacity() * sizeof(int) + mDirectionList.capacity() * sizeof(unsigned char) + mOpenList.size() * sizeof(OpenEntry);
+	}
+
+	void FlowField::repair(const NavigationGrid& _grid)
+	{
+		int directionStep = mAllowDiagonalMovements ? 1 : 2;
+
+		// The cells whose next moves lead to a changed cell lose their cost, the changed cells too except the goal
+		vector<int> invalidCellList;
+		for (auto it = mChangedCellList.begin(); it != mChangedCellList.end(); ++it)
+		{
+			if ((*it) != mGoalIndex && mDistanceList[*it] < INFINITE_DISTANCE)
+			{
+				mDistanceList[*it] = INFINITE_DISTANCE;
+				mDirectionList[*it] = NO_DIRECTION;
+				invalidCellList.push_back(*it);
+			}
+		}
+
+		vector<int> stack(mChangedCellList);
+		while (!stack.empty())
+		{
+			int actualIndex = stack.back();
+			stack.pop_back();
+
+			int x = NavigationGrid::getX(actualIndex);
+			int y = NavigationGrid::getY(actualIndex);
+			for (int direction = 0; direction < 8; direction += directionStep)
+			{
+				int neighbourX = x + NavigationGrid::NEIGHBOUR_X[direction];
+				int neighbourY = y + NavigationGrid::NEIGHBOUR_Y[direction];
+				if (!NavigationGrid::isInRange(neighbourX, neighbourY))
+					continue;
+
+				// The neighbour moves to the actual cell when its direction is the opposite one
+				int neighbourIndex = NavigationGrid::index(neighbourX, neighbourY);
+				if (mDirectionList[neighbourIndex] == ((direction + 4) & 7))
+				{
+					mDistanceList[neighbourIndex] = INFINITE_DISTANCE;
+					mDirectionList[neighbourIndex] = NO_DIRECTION;
+					invalidCellList.push_back(neighbourIndex);
+					stack.push_back(neighbourIndex);
+				}
+			}
+		}
+
+		// The changed cells not reached before may be reached now
+		for (auto it = mChangedCellList.begin(); it != mChangedCellList.end(); ++it)
+			if ((*it) != mGoalIndex && mDistanceList[*it] >= INFINITE_DISTANCE)
+				invalidCellList.push_back(*it);
+		mChangedCellList.clear();
+
+		// Each of these cells takes the best cost given by its neighbours, the open list spreads the costs to the others
+		for (auto it = invalidCellList.begin(); it != invalidCellList.end(); ++it)
+		{
+			int x = NavigationGrid::getX(*it);
+			int y = NavigationGrid::getY(*it);
+			for (int direction = 0; direction < 8; direction += directionStep)
+			{
+				int neighbourX = x + NavigationGrid::NEIGHBOUR_X[direction];
+				int neighbourY = y + NavigationGrid::NEIGHBOUR_Y[direction];
+				if (!NavigationGrid::isInRange(neighbourX, neighbourY))
+					continue;
+
+				int neighbourIndex = NavigationGrid::index(neighbourX, neighbourY);
+				if (mDistanceList[neighbourIndex] >= INFINITE_DISTANCE || !mMoveRule.canMove(_grid, *it, neighbourIndex))
+					continue;
+
+				int distance = mDistanceList[neighbourIndex] + ((direction & 1) ? MoveRule::COST_DIAGONAL : MoveRule::COST_STRAIGHT);
+				if (distance < mDistanceList[*it])
+				{
+					mDistanceList[*it] = distance;
+					mDirectionList[*it] = direction;
+				}
+			}
+
+			if (mDistanceList[*it] < INFINITE_DISTANCE)
+				mOpenList.push(OpenEntry{ mDistanceList[*it], *it });
+		}
+	}
+
+	void FlowField::updatePredecessors(const NavigationGrid& _grid, int _index)
+	{
+		int x = NavigationGrid::getX(_index);
+		int y = NavigationGrid::getY(_index);
+		int directionStep = mAllowDiagonalMovements ? 1 : 2;
+
+		for (int direction = 0; direction < 8; direction += directionStep)
+		{
+			int neighbourX = x + NavigationGrid::NEIGHBOUR_X[direction];
+			int neighbourY = y + NavigationGrid::NEIGHBOUR_Y[direction];
+			if (!NavigationGrid::isInRange(neighbourX, neighbourY))
+				continue;
+
+			int neighbourIndex = NavigationGrid::index(neighbourX, neighbourY);
+			int distance = mDistanceList[_index] + ((direction & 1) ? MoveRule::COST_DIAGONAL : MoveRule::COST_STRAIGHT);
+			if (distance < mDistanceList[neighbourIndex] && mMoveRule.canMove(_grid, neighbourIndex, _index))
+			{
+				// The neighbour moves back to the actual cell, in the opposite direction
+				mDistanceList[neighbourIndex] = distance;
+				mDirectionList[neighbourIndex] = (direction + 4) & 7;
+				mOpenList.push(OpenEntry{ distance, neighbourIndex });
+			}
+		}
+	}
+
+}
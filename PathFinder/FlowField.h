@@ -0,0 +1,120 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __FLOW_FIELD_H__
+#define __FLOW_FIELD_H__
+
+#include <climits>
+#include <vector>
+#include <queue>
+#include "PathFinderConfig.h"
+#include "NavigationGrid.h"
+#include "MoveRule.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// Cost to one goal from every cell and the direction of the next move toward it, shared by all the agents going to the goal.
+	/// The costs are computed by a Dijkstra search from the goal, following the moves backward.
+	///
+	/// The search only goes as far as the agents asking for their next move: it stops as soon as the cost of the cell asked is known,
+	/// and goes on from there for the next agent farther away.
+	/// When cells change, only the cells whose path to the goal crossed them are computed again.
+	/// </summary>
+	class FlowField
+	{
+
+	private:
+
+		/// <summary>
+		/// Cell in the open list, with its cost when it was added.
+		/// A cell can be in the list more than once, the entries with an outdated cost are skipped.
+		/// </summary>
+		struct OpenEntry
+		{
+			int distance;
+			int index;
+
+			inline bool operator>(const OpenEntry& _other) const { return distance > _other.distance; }
+		};
+
+		/// <summary>Cost of a cell that has not been reached.</summary>
+		static const int INFINITE_DISTANCE = INT_MAX / 2;
+
+		/// <summary>Direction of a cell without next move.</summary>
+		static const unsigned char NO_DIRECTION = 8;
+
+		MoveRule mMoveRule;
+
+		bool mAllowDiagonalMovements;
+
+		int mGoalIndex;
+
+		/// <summary>
+		/// Cost from each cell to the goal, see MoveRule::COST_STRAIGHT.
+		/// It is only the cost of a path found so far, and not the smallest one, while it is above the first cost of the open list.
+		/// </summary>
+		vector<int> mDistanceList;
+
+		/// <summary>Direction of the next cell on the path to the goal from each cell, see NavigationGrid::NEIGHBOUR_X.</summary>
+		vector<unsigned char> mDirectionList;
+
+		priority_queue<OpenEntry, vector<OpenEntry>, greater<OpenEntry>> mOpenList;
+
+		/// <summary>Cells changed since the last use of the field.</summary>
+		vector<int> mChangedCellList;
+
+
+	public:
+
+		FlowField(const MoveRule& _moveRule, bool _allowDiagonalMovements, int _goalIndex);
+
+		inline int getGoalIndex() const { return mGoalIndex; }
+
+		/// <summary>
+		/// Move the goal. The cost of almost every cell changes, so the search starts again, only as far as the agents ask.
+		/// </summary>
+		void setGoal(int _goalIndex);
+
+		/// <summary>
+		/// Tell the field that a rectangle of cells has changed, the costs are repaired with the next use.
+		/// </summary>
+		void setCellsChanged(int _x, int _y, int _width, int _depth);
+
+		/// <summary>
+		/// Get the next cell on the shortest path from a cell to the goal, the search goes on until the cost of the cell is known.
+		/// </summary>
+		/// <returns>False if the goal cannot be reached from the cell.</returns>
+		bool getNextStep(const NavigationGrid& _grid, int _index, int& _nextIndex);
+
+		/// <summary>
+		/// Number of bytes used by the field.
+		/// </summary>
+		size_t getMemorySize() const;
+
+
+	private:
+
+		/// <summary>
+		/// Compute again the costs of the cells whose path to the goal crossed a changed cell.
+		/// </summary>
+		void repair(const NavigationGrid& _grid);
+
+		/// <summary>
+		/// Give its cost to each cell that can move to a cell taken out of the open list.
+		/// </summary>
+		void updatePredecessors(const NavigationGrid& _grid, int _index);
+	};
+
+}
+
+#endif
@@ -0,0 +1,68 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __GRID_SOURCE_H__
+#define __GRID_SOURCE_H__
+
+#include "PathFinderConfig.h"
+
+namespace fournier
+{
+	/// <summary>
+	/// Interface used by the PathFinder to read the world it has to represent.
+	/// The PathFinder only needs the topmost cube of each column, a source is asked for a whole rectangle of columns at once
+	/// so that an implementation can read its own storage directly instead of doing one call per cube.
+	/// </summary>
+	class GridSource
+	{
+
+	public:
+
+		virtual ~GridSource()
+		{
+		}
+
+		/// <summary>
+		/// Size of the world in columns on the X axis, the size of the map of the PathFinder. MAT_SIZE_CUBES by default.
+		/// </summary>
+		virtual int getSizeX() const
+		{
+			return MAT_SIZE_CUBES;
+		}
+
+		/// <summary>
+		/// Size of the world in columns on the Y axis. MAT_SIZE_CUBES by default.
+		/// </summary>
+		virtual int getSizeY() const
+		{
+			return MAT_SIZE_CUBES;
+		}
+
+		/// <summary>
+		/// Read the topmost cube of every column in the given rectangle.
+		/// The lists are filled row by row: the column (_x + i, _y + j) is written at the index i + j * _width.
+		/// A column without any cube must be written with a height of 0 and the type CUBE_AIR.
+		/// PathFinder::initialize() calls it from several threads at once, with rectangles that do not overlap,
+		/// and so does the first search needing the whole map with the lazy loading. These threads only live during the call.
+		/// The other calls, like the pages reached by the searches with the lazy loading, are made by the thread calling the PathFinder,
+		/// never by its worker threads.
+		/// </summary>
+		/// <param name="_x">X position of the first column to read.</param>
+		/// <param name="_y">Y position of the first column to read.</param>
+		/// <param name="_width">Number of columns to read on the X axis.</param>
+		/// <param name="_depth">Number of columns to read on the Y axis.</param>
+		/// <param name="_heightList">Receives the height of the topmost cube of each column.</param>
+		/// <param name="_typeList">Receives the type of the topmost cube of each column.</param>
+		virtual void readColumns(int _x, int _y, int _width, int _depth, int* _heightList, NYCubeType* _typeList) const = 0;
+	};
+
+}
+
+#endif
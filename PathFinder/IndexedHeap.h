@@ -0,0 +1,191 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __INDEXED_HEAP_H__
+#define __INDEXED_HEAP_H__
+
+#include <vector>
+#include "SparseArray.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// Heap used as the open list of the A* search.
+	/// Each entry is a node index with its key (the F value), the smallest key being on top.
+	/// The heap also keeps the position of every node in its array, so finding a node to decrease its key is done in O(1)
+	/// and the whole decrease-key operation in O(log n).
+	/// The number of children per node is given by Arity, a 4-ary heap has a lower depth and its children share the same cache line.
+	/// </summary>
+	template <int Arity>
+	class IndexedHeap
+	{
+
+	private:
+
+		struct Entry
+		{
+			int key;
+			int node;
+		};
+
+		/// <summary>Entries of the heap, the children of the entry n are at the positions n * Arity + 1 to n * Arity + Arity.</summary>
+		vector<Entry> mEntryList;
+
+		/// <summary>Position + 1 of each node in mEntryList, 0 if the node is not in the heap, so only the nodes reached by a search take memory.</summary>
+		SparseArray<int> mPositionList;
+
+
+	public:
+
+		IndexedHeap()
+		{
+		}
+
+		/// <summary>
+		/// Allocate the heap, it must be called before using it. Calling it again gives back the memory used by the nodes.
+		/// </summary>
+		/// <param name="_numberNode">Number of different nodes that can be added in the heap.</param>
+		inline void initialize(int _numberNode)
+		{
+			mEntryList.clear();
+			mEntryList.shrink_to_fit();
+			mPositionList.assign(_numberNode);
+		}
+
+		inline bool isEmpty() const { return mEntryList.empty(); }
+
+		inline int size() const { return (int)mEntryList.size(); }
+
+		inline bool contains(int _node) const { return mPositionList[_node] != 0; }
+
+		/// <summary>
+		/// Get the smallest key of the heap, which must not be empty.
+		/// </summary>
+		inline int topKey() const { return mEntryList[0].key; }
+
+		inline void push(int _node, int _key)
+		{
+			Entry entry;
+			entry.key = _key;
+			entry.node = _node;
+
+			mEntryList.push_back(entry);
+			siftUp((int)mEntryList.size() - 1);
+		}
+
+		/// <summary>
+		/// Give a smaller key to a node already in the heap.
+		/// </summary>
+		inline void decreaseKey(int _node, int _key)
+		{
+			int position = mPositionList[_node] - 1;
+			if (position == -1)
+				return;
+
+			mEntryList[position].key = _key;
+			siftUp(position);
+		}
+
+		/// <summary>
+		/// Remove the node with the smallest key from the heap.
+		/// </summary>
+		/// <returns>The removed node, or -1 if the heap is empty.</returns>
+		inline int pop()
+		{
+			if (mEntryList.empty())
+				return -1;
+
+			int node = mEntryList[0].node;
+			mPositionList[node] = 0;
+
+			// Place the last element at the first position before removing it
+			mEntryList[0] = mEntryList.back();
+			mEntryList.pop_back();
+
+			if (!mEntryList.empty())
+				siftDown(0);
+
+			return node;
+		}
+
+		/// <summary>
+		/// Remove every node from the heap.
+		/// </summary>
+		inline void clear()
+		{
+			for (auto it = mEntryList.begin(); it != mEntryList.end(); ++it)
+				mPositionList[(*it).node] = 0;
+			mEntryList.clear();
+		}
+
+
+	private:
+
+		inline void siftUp(int _position)
+		{
+			Entry entry = mEntryList[_position];
+
+			while (_position > 0)
+			{
+				int parent = (_position - 1) / Arity;
+
+				// Check if the node has a bigger key than its actual parent
+				if (entry.key > mEntryList[parent].key)
+					break;
+
+				// Move the parent down
+				mEntryList[_position] = mEntryList[parent];
+				mPositionList[mEntryList[_position].node] = _position + 1;
+				_position = parent;
+			}
+
+			mEntryList[_position] = entry;
+			mPositionList[entry.node] = _position + 1;
+		}
+
+		inline void siftDown(int _position)
+		{
+			Entry entry = mEntryList[_position];
+			int numberItem = (int)mEntryList.size();
+
+			while (true)
+			{
+				int firstChild = _position * Arity + 1;
+				if (firstChild >= numberItem)
+					break;
+
+				// Find the child with the lowest key
+				int lastChild = (firstChild + Arity < numberItem) ? firstChild + Arity : numberItem;
+				int bestChild = firstChild;
+				for (int child = firstChild + 1; child < lastChild; ++child)
+				{
+					if (mEntryList[child].key < mEntryList[bestChild].key)
+						bestChild = child;
+				}
+
+				if (mEntryList[bestChild].key >= entry.key)
+					break;
+
+				// The child was better, move it up
+				mEntryList[_position] = mEntryList[bestChild];
+				mPositionList[mEntryList[_position].node] = _position + 1;
+				_position = bestChild;
+			}
+
+			mEntryList[_position] = entry;
+			mPositionList[entry.node] = _position + 1;
+		}
+	};
+
+}
+
+#endif
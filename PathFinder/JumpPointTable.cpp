@@ -0,0 +1,383 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "JumpPointTable.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+
+namespace fournier
+{
+	/// <summary>
+	/// How a neighbour w of a cell n is handled, when n is reached from the cell c with a move in a given direction.
+	/// The paths from c to w avoiding n are the direct move, if canBeDirect, and the paths c -> m -> w through the listed intermediates.
+	/// The positions are relative to n.
+	/// </summary>
+	struct NeighbourRule
+	{
+		bool isNatural;
+		bool isParent;
+		bool canBeDirect;
+		int numberIntermediate;
+		int intermediateX[8];
+		int intermediateY[8];
+	};
+
+	struct NeighbourRuleTable
+	{
+		NeighbourRule ruleList[8][8];
+
+		/// <summary>Neighbours that are neither natural nor the parent, for each direction.</summary>
+		int candidateList[8][6];
+		int numberCandidateList[8];
+
+		NeighbourRuleTable()
+		{
+			const int* neighbourX = NavigationGrid::NEIGHBOUR_X;
+			const int* neighbourY = NavigationGrid::NEIGHBOUR_Y;
+
+			// Only the order between the costs of two moves is used, so any diagonal cost bigger than the straight cost gives the same table
+			auto cost = [](int _x, int _y) { return (_x != 0 && _y != 0) ? 3 : 2; };
+			auto isAdjacent = [](int _x1, int _y1, int _x2, int _y2) { return abs(_x1 - _x2) <= 1 && abs(_y1 - _y2) <= 1 && (_x1 != _x2 || _y1 != _y2); };
+
+			for (int d = 0; d < 8; ++d)
+			{
+				int dx = neighbourX[d];
+				int dy = neighbourY[d];
+				bool isDiagonal = (d & 1) != 0;
+				numberCandidateList[d] = 0;
+
+				for (int w = 0; w < 8; ++w)
+				{
+					NeighbourRule& rule = ruleList[d][w];
+					int wx = neighbourX[w];
+					int wy = neighbourY[w];
+
+					rule.isParent = (wx == -dx && wy == -dy);
+					rule.isNatural = (wx == dx && wy == dy) || (isDiagonal && ((wx == dx && wy == 0) || (wx == 0 && wy == dy)));
+					rule.canBeDirect = false;
+					rule.numberIntermediate = 0;
+
+					if (rule.isParent || rule.isNatural)
+						continue;
+
+					candidateList[d][numberCandidateList[d]++] = w;
+
+					// A path as long as the one through n is enough to prune w after a straight move, it must be shorter after a diagonal move
+					int costThroughN = cost(dx, dy) + cost(wx, wy);
+					auto isAlternative = [&](int _cost) { return isDiagonal ? _cost < costThroughN : _cost <= costThroughN; };
+
+					if (isAdjacent(-dx, -dy, wx, wy))
+						rule.canBeDirect = isAlternative(cost(wx + dx, wy + dy));
+
+					for (int m = 0; m < 8; ++m)
+					{
+						int mx = -dx + neighbourX[m];
+						int my = -dy + neighbourY[m];
+
+						if ((mx == 0 && my == 0) || !isAdjacent(mx, my, wx, wy))
+							continue;
+
+						if (isAlternative(cost(neighbourX[m], neighbourY[m]) + cost(wx - mx, wy - my)))
+						{
+							rule.intermediateX[rule.numberIntermediate] = mx;
+							rule.intermediateY[rule.numberIntermediate] = my;
+							++rule.numberIntermediate;
+						}
+					}
+				}
+			}
+		}
+	};
+
+	static const NeighbourRuleTable& getNeighbourRules()
+	{
+		static const NeighbourRuleTable ruleTable;
+		return ruleTable;
+	}
+
+
+	JumpPointTable::JumpPointTable(const MoveRule& _moveRule)
+		: mMoveRule(_moveRule), mIsDirty(true)
+	{
+	}
+
+	void JumpPointTable::build(const NavigationGrid& _grid)
+	{
+		int sizeX = NavigationGrid::getSizeX();
+		int sizeY = NavigationGrid::getSizeY();
+		mJumpList.assign(NavigationGrid::getNumberIndex() * 8, 0);
+		mIrregularCellList.resize(NavigationGrid::getNumberIndex());
+
+		for (int y = 0; y < sizeY; ++y)
+		{
+			for (int x = 0; x < sizeX; ++x)
+				mIrregularCellList[NavigationGrid::index(x, y)] = computeIsIrregular(_grid, x, y) ? 1 : 0;
+		}
+
+		// The straight jumps are computed first, the diagonal jumps use them
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			for (int direction = pass; direction < 8; direction += 2)
+			{
+				int dx = NavigationGrid::NEIGHBOUR_X[direction];
+				int dy = NavigationGrid::NEIGHBOUR_Y[direction];
+
+				// The cells are visited against the direction, so the jump of the next cell is already known
+				int startX = (dx > 0) ? sizeX - 1 : 0;
+				int startY = (dy > 0) ? sizeY - 1 : 0;
+				int stepX = (dx > 0) ? -1 : 1;
+				int stepY = (dy > 0) ? -1 : 1;
+
+				for (int j = 0, y = startY; j < sizeY; ++j, y += stepY)
+				{
+					for (int i = 0, x = startX; i < sizeX; ++i, x += stepX)
+						mJumpList[NavigationGrid::index(x, y) * 8 + direction] = computeJump(_grid, x, y, direction);
+				}
+			}
+		}
+
+		mChangedCellList.clear();
+		mIsDirty = false;
+	}
+
+	void JumpPointTable::setCellsChanged(const NavigationGrid& _grid, int _x, int _y, int _width, int _depth)
+	{
+		if (mIsDirty)
+			return;
+
+		// A cell is irregular because of the cells around it
+		for (int y = max(0, _y - 1); y <= min(NavigationGrid::getSizeY() - 1, _y + _depth); ++y)
+		{
+			for (int x = max(0, _x - 1); x <= min(NavigationGrid::getSizeX() - 1, _x + _width); ++x)
+			{
+				int actualIndex = NavigationGrid::index(x, y);
+				unsigned char isIrregular = computeIsIrregular(_grid, x, y) ? 1 : 0;
+				if (mIrregularCellList[actualIndex] == isIrregular)
+					continue;
+
+				mIrregularCellList[actualIndex] = isIrregular;
+				mChangedCellList.push_back(actualIndex);
+			}
+		}
+
+		// The jump from a cell c to its neighbour n reads the cells up to 2 cells away from n, and the jumps from n
+		// So the jumps to compute again are the ones to the cells of the rectangle grown by 2, and the ones to a cell whose jump has changed
+		int firstX = max(0, _x - 2);
+		int firstY = max(0, _y - 2);
+		int lastX = min(NavigationGrid::getSizeX() - 1, _x + _width + 1);
+		int lastY = min(NavigationGrid::getSizeY() - 1, _y + _depth + 1);
+
+		// Cells whose straight jump has found or lost its jump point, the diagonal jumps through them check it
+		vector<int> signChangedList[8];
+
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			for (int direction = pass; direction < 8; direction += 2)
+			{
+				int dx = NavigationGrid::NEIGHBOUR_X[direction];
+				int dy = NavigationGrid::NEIGHBOUR_Y[direction];
+
+				vector<int> seedList;
+				for (int y = firstY; y <= lastY; ++y)
+					for (int x = firstX; x <= lastX; ++x)
+						seedList.push_back(NavigationGrid::index(x, y));
+				if (pass == 1)
+				{
+					const vector<int>& previousList = signChangedList[(direction + 7) & 7];
+					const vector<int>& nextList = signChangedList[(direction + 1) & 7];
+					seedList.insert(seedList.end(), previousList.begin(), previousList.end());
+					seedList.insert(seedList.end(), nextList.begin(), nextList.end());
+				}
+
+				// The farthest cells in the direction first, the jump of a cell uses the one of the next cell
+				sort(seedList.begin(), seedList.end(), [dx, dy](int _first, int _second)
+				{
+					return NavigationGrid::getX(_first) * dx + NavigationGrid::getY(_first) * dy > NavigationGrid::getX(_second) * dx + NavigationGrid::getY(_second) * dy;
+				});
+
+				// From each seed, walk back against the direction while the jumps change
+				for (auto seed = seedList.begin(); seed != seedList.end(); ++seed)
+				{
+					int x = NavigationGrid::getX(*seed) - dx;
+					int y = NavigationGrid::getY(*seed) - dy;
+					while (NavigationGrid::isInRange(x, y))
+					{
+						int actualIndex = NavigationGrid::index(x, y);
+						short& jump = mJumpList[actualIndex * 8 + direction];
+						short newJump = computeJump(_grid, x, y, direction);
+						if (newJump == jump)
+							break;
+
+						if ((newJump > 0) != (jump > 0))
+							signChangedList[direction].push_back(actualIndex);
+						jump = newJump;
+						mChangedCellList.push_back(actualIndex);
+						x -= dx;
+						y -= dy;
+					}
+				}
+			}
+		}
+	}
+
+	size_t JumpPointTable::getMemorySize() const
+	{
+		return mJumpList.capacity() * sizeof(short) + mIrregularCellList.capacity();
+	}
+
+	int JumpPointTable::jump(int _x, int _y, int _direction, int _endX, int _endY) const
+	{
+		int jump = mJumpList[NavigationGrid::index(_x, _y) * 8 + _direction];
+		int numberReachableCell = (jump > 0) ? jump : -jump;
+		int dx = NavigationGrid::NEIGHBOUR_X[_direction];
+		int dy = NavigationGrid::NEIGHBOUR_Y[_direction];
+
+		// Number of moves needed to reach the destination, or its row or column for a diagonal jump
+		int distanceX = (_endX - _x) * dx;
+		int distanceY = (_endY - _y) * dy;
+		int distanceToEnd = 0;
+		if (dx == 0)
+			distanceToEnd = (_endX == _x) ? distanceY : 0;
+		else if (dy == 0)
+			distanceToEnd = (_endY == _y) ? distanceX : 0;
+		else if (distanceX > 0 && distanceY > 0)
+			distanceToEnd = (distanceX < distanceY) ? distanceX : distanceY;
+
+		if (distanceToEnd > 0 && distanceToEnd <= numberReachableCell)
+			return distanceToEnd;
+		return (jump > 0) ? jump : 0;
+	}
+
+	short JumpPointTable::computeJump(const NavigationGrid& _grid, int _x, int _y, int _direction) const
+	{
+		int nextX = _x + NavigationGrid::NEIGHBOUR_X[_direction];
+		int nextY = _y + NavigationGrid::NEIGHBOUR_Y[_direction];
+		if (!NavigationGrid::isInRange(nextX, nextY))
+			return 0;
+
+		int nextIndex = NavigationGrid::index(nextX, nextY);
+		if (!mMoveRule.canMove(_grid, NavigationGrid::index(_x, _y), nextIndex))
+			return 0;
+
+		bool isJumpPoint = mIrregularCellList[nextIndex] || hasForcedNeighbour(_grid, nextX, nextY, _direction);
+		if (!isJumpPoint && (_direction & 1) != 0)
+			isJumpPoint = mJumpList[nextIndex * 8 + ((_direction + 7) & 7)] > 0 || mJumpList[nextIndex * 8 + ((_direction + 1) & 7)] > 0;
+
+		if (isJumpPoint)
+			return 1;
+
+		short nextJump = mJumpList[nextIndex * 8 + _direction];
+		return (nextJump > 0) ? nextJump + 1 : nextJump - 1;
+	}
+
+	bool JumpPointTable::isNeighbourKept(const NavigationGrid& _grid, int _x, int _y, int _direction, int _neighbour) const
+	{
+		const NeighbourRule& rule = getNeighbourRules().ruleList[_direction][_neighbour];
+		if (rule.isParent)
+			return false;
+		return rule.isNatural || isForcedNeighbour(_grid, _x, _y, _direction, _neighbour);
+	}
+
+	bool JumpPointTable::computeIsIrregular(const NavigationGrid& _grid, int _x, int _y) const
+	{
+		// Heights of the walkable cells around the cell, INT_MIN for the others
+		int heightList[3][3];
+		for (int j = 0; j < 3; ++j)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				int x = _x + i - 1;
+				int y = _y + j - 1;
+				heightList[i][j] = INT_MIN;
+
+				if (!NavigationGrid::isInRange(x, y))
+					continue;
+
+				const NavigationCell& cell = _grid.cell(NavigationGrid::index(x, y));
+				if (mMoveRule.isWalkable(cell))
+					heightList[i][j] = cell.height;
+			}
+		}
+
+		int maximumDifference = (mMoveRule.maximumJumpHeight < mMoveRule.maximumFallHeight) ? mMoveRule.maximumJumpHeight : mMoveRule.maximumFallHeight;
+
+		// Each pair of adjacent cells of the block is checked once
+		static const int PAIR_X[4] = { 1, 1, 0, -1 };
+		static const int PAIR_Y[4] = { 0, 1, 1, 1 };
+		for (int j = 0; j < 3; ++j)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				if (heightList[i][j] == INT_MIN)
+					continue;
+
+				for (int p = 0; p < 4; ++p)
+				{
+					int otherI = i + PAIR_X[p];
+					int otherJ = j + PAIR_Y[p];
+					if (otherI < 0 || otherI > 2 || otherJ > 2 || heightList[otherI][otherJ] == INT_MIN)
+						continue;
+
+					if (abs(heightList[i][j] - heightList[otherI][otherJ]) > maximumDifference)
+						return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	bool JumpPointTable::isForcedNeighbour(const NavigationGrid& _grid, int _x, int _y, int _direction, int _neighbour) const
+	{
+		const NeighbourRule& rule = getNeighbourRules().ruleList[_direction][_neighbour];
+		int neighbourX = _x + NavigationGrid::NEIGHBOUR_X[_neighbour];
+		int neighbourY = _y + NavigationGrid::NEIGHBOUR_Y[_neighbour];
+
+		if (!NavigationGrid::isInRange(neighbourX, neighbourY))
+			return false;
+
+		// Look for a path avoiding the cell first, on open ground it is found with the first move checked
+		// The cell we came from is always in the map
+		int neighbourIndex = NavigationGrid::index(neighbourX, neighbourY);
+		int previousIndex = NavigationGrid::index(_x - NavigationGrid::NEIGHBOUR_X[_direction], _y - NavigationGrid::NEIGHBOUR_Y[_direction]);
+		if (rule.canBeDirect && mMoveRule.canMove(_grid, previousIndex, neighbourIndex))
+			return false;
+
+		for (int m = 0; m < rule.numberIntermediate; ++m)
+		{
+			int intermediateX = _x + rule.intermediateX[m];
+			int intermediateY = _y + rule.intermediateY[m];
+			if (!NavigationGrid::isInRange(intermediateX, intermediateY))
+				continue;
+
+			int intermediateIndex = NavigationGrid::index(intermediateX, intermediateY);
+			if (mMoveRule.canMove(_grid, previousIndex, intermediateIndex) && mMoveRule.canMove(_grid, intermediateIndex, neighbourIndex))
+				return false;
+		}
+
+		return mMoveRule.canMove(_grid, NavigationGrid::index(_x, _y), neighbourIndex);
+	}
+
+	bool JumpPointTable::hasForcedNeighbour(const NavigationGrid& _grid, int _x, int _y, int _direction) const
+	{
+		const NeighbourRuleTable& ruleTable = getNeighbourRules();
+
+		for (int n = 0; n < ruleTable.numberCandidateList[_direction]; ++n)
+		{
+			if (isForcedNeighbour(_grid, _x, _y, _direction, ruleTable.candidateList[_direction][n]))
+				return true;
+		}
+		return false;
+	}
+
+}
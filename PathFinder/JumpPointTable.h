@@ -0,0 +1,133 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __JUMP_POINT_TABLE_H__
+#define __JUMP_POINT_TABLE_H__
+
+#include <vector>
+#include "PathFinderConfig.h"
+#include "NavigationGrid.h"
+#include "MoveRule.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// Precomputed jumps used by the Jump Point Search (JPS+) of one MoveRule.
+	/// From each cell and in each of the 8 directions, a jump walks in a straight or diagonal line until it finds a jump point:
+	/// a cell with a forced neighbour, or for a diagonal jump a cell from which one of the two straight jumps finds a jump point.
+	/// The table stores the length of each jump, so the search does not have to walk on the cells between two jump points.
+	///
+	/// A neighbour w of a cell n, reached from the cell c, is forced when every path from c to w avoiding n is blocked or longer than the one through n.
+	///
+	/// The pruning of the neighbours is only valid on a grid where a move between two walkable cells is possible both ways.
+	/// The jumps and falls break this: a cell is irregular when two walkable cells around it (itself included) cannot be walked between both ways.
+	/// The irregular cells are always jump points and the search looks at all their neighbours, like for the start node.
+	/// On flat or gentle ground, where no height difference is above the maximum jump and fall heights, no cell is irregular.
+	/// </summary>
+	class JumpPointTable
+	{
+
+	private:
+
+		MoveRule mMoveRule;
+
+		/// <summary>
+		/// Length of the jump from each cell in each direction, at the index * 8 + direction.
+		/// A positive length k means that there is a jump point k cells away,
+		/// a negative or null length -k means that the jump is blocked after k cells without finding a jump point.
+		/// </summary>
+		vector<short> mJumpList;
+
+		/// <summary>1 for the irregular cells, 0 for the others.</summary>
+		vector<unsigned char> mIrregularCellList;
+
+		/// <summary>The table has not been built yet.</summary>
+		bool mIsDirty;
+
+		/// <summary>Cells whose jump in a direction or irregular flag has changed since the last clearChangedCells(), with duplicates.</summary>
+		vector<int> mChangedCellList;
+
+
+	public:
+
+		JumpPointTable(const MoveRule& _moveRule);
+
+		inline const MoveRule& getMoveRule() const { return mMoveRule; }
+
+		inline bool isDirty() const { return mIsDirty; }
+
+		/// <summary>
+		/// Compute the jumps of every cell, in O(cells).
+		/// </summary>
+		void build(const NavigationGrid& _grid);
+
+		/// <summary>
+		/// Compute again the jumps changed by a rectangle of cells, the grid must already hold the new cells.
+		/// Only the jumps that lead into the rectangle are followed back, as long as they change.
+		/// </summary>
+		void setCellsChanged(const NavigationGrid& _grid, int _x, int _y, int _width, int _depth);
+
+		/// <summary>
+		/// Cells whose jumps or irregular flag have been changed by setCellsChanged(), a search that has expanded one of them must start again.
+		/// </summary>
+		inline const vector<int>& getChangedCellList() const { return mChangedCellList; }
+
+		inline void clearChangedCells() { mChangedCellList.clear(); }
+
+		/// <summary>
+		/// Number of bytes used by the table.
+		/// </summary>
+		size_t getMemorySize() const;
+
+		/// <summary>
+		/// Find the next jump point from a cell in one direction.
+		/// The destination of the search is also a jump point, and a diagonal jump stops in the row or column of the destination.
+		/// </summary>
+		/// <param name="_x">X position of the cell to jump from.</param>
+		/// <param name="_y">Y position of the cell to jump from.</param>
+		/// <param name="_direction">Index of the direction, see NavigationGrid::NEIGHBOUR_X.</param>
+		/// <param name="_endX">X position of the destination of the search.</param>
+		/// <param name="_endY">Y position of the destination of the search.</param>
+		/// <returns>Number of cells to the jump point, or 0 if the jump is blocked before finding one.</returns>
+		int jump(int _x, int _y, int _direction, int _endX, int _endY) const;
+
+		/// <summary>
+		/// Indicate if every neighbour of a cell must be looked at, whatever the direction it was reached from.
+		/// </summary>
+		inline bool isIrregular(int _index) const { return mIrregularCellList[_index] != 0; }
+
+		/// <summary>
+		/// Indicate if the search must look at a neighbour of a cell reached with a move in the given direction:
+		/// the natural neighbours where the move continues, and the forced neighbours.
+		/// </summary>
+		/// <param name="_direction">Index of the direction of the move to the cell.</param>
+		/// <param name="_neighbour">Index of the direction of the neighbour.</param>
+		bool isNeighbourKept(const NavigationGrid& _grid, int _x, int _y, int _direction, int _neighbour) const;
+
+
+	private:
+
+		/// <summary>
+		/// Length of the jump from a cell in one direction, the jumps of the next cell must be known.
+		/// </summary>
+		short computeJump(const NavigationGrid& _grid, int _x, int _y, int _direction) const;
+
+		bool computeIsIrregular(const NavigationGrid& _grid, int _x, int _y) const;
+
+		bool isForcedNeighbour(const NavigationGrid& _grid, int _x, int _y, int _direction, int _neighbour) const;
+
+		bool hasForcedNeighbour(const NavigationGrid& _grid, int _x, int _y, int _direction) const;
+	};
+
+}
+
+#endif
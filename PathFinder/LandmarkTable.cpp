@@ -0,0 +1,156 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "LandmarkTable.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+
+namespace fournier
+{
+	LandmarkTable::LandmarkTable(const MoveRule& _moveRule, bool _allowDiagonalMovements)
+		: mMoveRule(_moveRule), mAllowDiagonalMovements(_allowDiagonalMovements), mNumberStaleLandmarks(0), mNextStaleLandmark(0)
+	{
+	}
+
+	void LandmarkTable::build(const TraversalProfile& _traversalProfile)
+	{
+		int numberIndex = NavigationGrid::getNumberIndex();
+		int numberCells = NavigationGrid::getSizeX() * NavigationGrid::getSizeY();
+		mDistanceToList.assign(numberIndex * NUMBER_LANDMARKS, (unsigned short)UNREACHABLE);
+		mDistanceFromList.assign(numberIndex * NUMBER_LANDMARKS, (unsigned short)UNREACHABLE);
+		mLandmarkList.clear();
+
+		// The first landmark is the cell farthest from the first cell with a move, a corner of the map on an open ground
+		// The cells are read by position, so the landmarks do not depend on the order of the indexes
+		int firstIndex = 0;
+		for (int n = 0; n < numberCells; ++n)
+		{
+			firstIndex = NavigationGrid::index(n % NavigationGrid::getSizeX(), n / NavigationGrid::getSizeX());
+			if (_traversalProfile.getMoveMask(firstIndex) != 0)
+				break;
+		}
+
+		vector<int> distanceList;
+		computeDistances(_traversalProfile, firstIndex, false, distanceList);
+
+		// Cost from the nearest landmark chosen so far, the next landmark is the cell where it is the largest
+		vector<int> nearestList(distanceList);
+
+		for (int landmark = 0; landmark < NUMBER_LANDMARKS; ++landmark)
+		{
+			int farthestIndex = firstIndex;
+			int farthestDistance = -1;
+			for (int n = 0; n < numberCells; ++n)
+			{
+				int index = NavigationGrid::index(n % NavigationGrid::getSizeX(), n / NavigationGrid::getSizeX());
+				if (nearestList[index] != INT_MAX && nearestList[index] > farthestDistance)
+				{
+					farthestDistance = nearestList[index];
+					farthestIndex = index;
+				}
+			}
+
+			mLandmarkList.push_back(farthestIndex);
+			computeLandmark(_traversalProfile, landmark);
+
+			for (int index = 0; index < numberIndex; ++index)
+			{
+				unsigned short distance = mDistanceFromList[index * NUMBER_LANDMARKS + landmark];
+				if (distance != UNREACHABLE)
+					nearestList[index] = min(nearestList[index], (int)distance * DISTANCE_UNIT);
+			}
+		}
+
+		mNumberStaleLandmarks = 0;
+		mNextStaleLandmark = 0;
+	}
+
+	void LandmarkTable::refresh(const TraversalProfile& _traversalProfile)
+	{
+		if (mNumberStaleLandmarks == 0)
+			return;
+
+		computeLandmark(_traversalProfile, mNextStaleLandmark);
+		mNextStaleLandmark = (mNextStaleLandmark + 1) % NUMBER_LANDMARKS;
+		--mNumberStaleLandmarks;
+	}
+
+	size_t LandmarkTable::getMemorySize() const
+	{
+		return (mDistanceToList.capacity() + mDistanceFromList.capacity()) * sizeof(unsigned short) + mLandmarkList.capacity() * sizeof(int);
+	}
+
+	void LandmarkTable::computeLandmark(const TraversalProfile& _traversalProfile, int _landmark)
+	{
+		vector<int> distanceList;
+		for (int isBackward = 0; isBackward < 2; ++isBackward)
+		{
+			// The cost to the landmark is found by following the moves backward from it
+			computeDistances(_traversalProfile, mLandmarkList[_landmark], isBackward != 0, distanceList);
+			vector<unsigned short>& storedList = isBackward ? mDistanceToList : mDistanceFromList;
+
+			for (int index = 0; index < NavigationGrid::getNumberIndex(); ++index)
+			{
+				unsigned short distance = UNREACHABLE;
+				if (distanceList[index] != INT_MAX)
+					distance = (unsigned short)min(distanceList[index] / DISTANCE_UNIT, (int)MAXIMUM_DISTANCE);
+				storedList[index * NUMBER_LANDMARKS + _landmark] = distance;
+			}
+		}
+	}
+
+	void LandmarkTable::computeDistances(const TraversalProfile& _traversalProfile, int _sourceIndex, bool _isBackward, vector<int>& _distanceList) const
+	{
+		typedef pair<int, int> OpenEntry;
+		priority_queue<OpenEntry, vector<OpenEntry>, greater<OpenEntry>> openList;
+		int directionStep = mAllowDiagonalMovements ? 1 : 2;
+
+		_distanceList.assign(NavigationGrid::getNumberIndex(), INT_MAX);
+		_distanceList[_sourceIndex] = 0;
+		openList.push(OpenEntry(0, _sourceIndex));
+
+		while (!openList.empty())
+		{
+			OpenEntry entry = openList.top();
+			openList.pop();
+			if (entry.first != _distanceList[entry.second])
+				continue;
+
+			int x = NavigationGrid::getX(entry.second);
+			int y = NavigationGrid::getY(entry.second);
+			int moveMask = _traversalProfile.getMoveMask(entry.second);
+
+			for (int direction = 0; direction < 8; direction += directionStep)
+			{
+				int neighbourX = x + NavigationGrid::NEIGHBOUR_X[direction];
+				int neighbourY = y + NavigationGrid::NEIGHBOUR_Y[direction];
+				if (!NavigationGrid::isInRange(neighbourX, neighbourY))
+					continue;
+
+				// Backward, the move goes from the neighbour to the cell
+				int neighbourIndex = NavigationGrid::index(neighbourX, neighbourY);
+				bool canMove = _isBackward ? (_traversalProfile.getMoveMask(neighbourIndex) & (1 << ((direction + 4) & 7))) != 0 : (moveMask & (1 << direction)) != 0;
+				if (!canMove)
+					continue;
+
+				int distance = entry.first + ((direction & 1) ? MoveRule::COST_DIAGONAL : MoveRule::COST_STRAIGHT);
+				if (distance < _distanceList[neighbourIndex])
+				{
+					_distanceList[neighbourIndex] = distance;
+					openList.push(OpenEntry(distance, neighbourIndex));
+				}
+			}
+		}
+	}
+
+}
@@ -0,0 +1,153 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __LANDMARK_TABLE_H__
+#define __LANDMARK_TABLE_H__
+
+#include <climits>
+#include <vector>
+#include "PathFinderConfig.h"
+#include "NavigationGrid.h"
+#include "MoveRule.h"
+#include "TraversalProfile.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// Costs between a few landmark cells and every cell of the map for one MoveRule, used as the ALT heuristic of the A* search.
+	/// With the triangle inequality, the cost from a cell n to the destination t is at least d(n, L) - d(t, L) and d(L, t) - d(L, n) for each landmark L.
+	/// Around a lake or a mountain range, this bound knows the length of the detour where the Manhattan distance only sees the straight line.
+	///
+	/// The costs are stored in units of DISTANCE_UNIT on 16 bits, in both directions since the jumps and falls make the moves asymmetric.
+	/// The landmarks are chosen far from each other, each one the cell farthest from the ones already chosen.
+	/// When the map changes the costs are kept and refreshed one landmark at a time, with each use of the table.
+	/// </summary>
+	class LandmarkTable
+	{
+
+	public:
+
+		/// <summary>Number of landmarks of a table.</summary>
+		static const int NUMBER_LANDMARKS = 8;
+
+		/// <summary>Cost of one unit of the stored costs, see MoveRule::COST_STRAIGHT.</summary>
+		static const int DISTANCE_UNIT = 16;
+
+
+	private:
+
+		/// <summary>Stored cost of a cell that cannot reach or be reached from a landmark.</summary>
+		static const unsigned short UNREACHABLE = 0xFFFF;
+
+		/// <summary>Largest stored cost, the longer costs are clamped to it and cannot be used.</summary>
+		static const unsigned short MAXIMUM_DISTANCE = 0xFFFE;
+
+		MoveRule mMoveRule;
+
+		bool mAllowDiagonalMovements;
+
+		/// <summary>Index of the cell of each landmark, empty until the table is built.</summary>
+		vector<int> mLandmarkList;
+
+		/// <summary>Cost from each cell to each landmark, at the index * NUMBER_LANDMARKS + landmark.</summary>
+		vector<unsigned short> mDistanceToList;
+
+		/// <summary>Cost from each landmark to each cell, at the index * NUMBER_LANDMARKS + landmark.</summary>
+		vector<unsigned short> mDistanceFromList;
+
+		/// <summary>Number of landmarks whose costs are older than the map.</summary>
+		int mNumberStaleLandmarks;
+
+		/// <summary>Next landmark to refresh.</summary>
+		int mNextStaleLandmark;
+
+
+	public:
+
+		LandmarkTable(const MoveRule& _moveRule, bool _allowDiagonalMovements);
+
+		inline const MoveRule& getMoveRule() const { return mMoveRule; }
+
+		inline bool allowsDiagonalMovements() const { return mAllowDiagonalMovements; }
+
+		/// <summary>
+		/// Indicate if the table has never been built.
+		/// </summary>
+		inline bool isDirty() const { return mLandmarkList.empty(); }
+
+		/// <summary>
+		/// Indicate if the costs of some landmarks were computed on an older map.
+		/// </summary>
+		inline bool isStale() const { return mNumberStaleLandmarks > 0; }
+
+		/// <summary>
+		/// Choose the landmarks and compute their costs, with two Dijkstra searches by landmark.
+		/// </summary>
+		/// <param name="_traversalProfile">Up to date moves of the MoveRule of the table.</param>
+		void build(const TraversalProfile& _traversalProfile);
+
+		/// <summary>
+		/// Compute again the costs of the landmark refreshed the longest time ago, if the map has changed since.
+		/// </summary>
+		void refresh(const TraversalProfile& _traversalProfile);
+
+		/// <summary>
+		/// Mark every landmark to be refreshed, the old costs are used until then.
+		/// </summary>
+		inline void setCellsChanged() { mNumberStaleLandmarks = mLandmarkList.empty() ? 0 : NUMBER_LANDMARKS; }
+
+		/// <summary>
+		/// Lower bound of the cost from a cell to another, from the landmarks.
+		/// It may be too high for the cells that changed since the landmarks were refreshed.
+		/// </summary>
+		inline int getLowerBound(int _index, int _destinationIndex) const
+		{
+			const unsigned short* distanceTo = &mDistanceToList[_index * NUMBER_LANDMARKS];
+			const unsigned short* distanceFrom = &mDistanceFromList[_index * NUMBER_LANDMARKS];
+			const unsigned short* destinationTo = &mDistanceToList[_destinationIndex * NUMBER_LANDMARKS];
+			const unsigned short* destinationFrom = &mDistanceFromList[_destinationIndex * NUMBER_LANDMARKS];
+
+			// A stored cost k is a cost between k and k + 1 units, so one unit is taken away from each difference
+			int bound = 0;
+			for (int landmark = 0; landmark < NUMBER_LANDMARKS; ++landmark)
+			{
+				if (distanceTo[landmark] < MAXIMUM_DISTANCE && destinationTo[landmark] < MAXIMUM_DISTANCE)
+					bound = max(bound, distanceTo[landmark] - destinationTo[landmark] - 1);
+				if (distanceFrom[landmark] < MAXIMUM_DISTANCE && destinationFrom[landmark] < MAXIMUM_DISTANCE)
+					bound = max(bound, destinationFrom[landmark] - distanceFrom[landmark] - 1);
+			}
+			return bound * DISTANCE_UNIT;
+		}
+
+		/// <summary>
+		/// Number of bytes used by the table.
+		/// </summary>
+		size_t getMemorySize() const;
+
+
+	private:
+
+		/// <summary>
+		/// Compute the costs of one landmark, in both directions.
+		/// </summary>
+		void computeLandmark(const TraversalProfile& _traversalProfile, int _landmark);
+
+		/// <summary>
+		/// Dijkstra search from a cell over the whole map, following the moves forward or backward.
+		/// </summary>
+		/// <param name="_distanceList">Cost of each cell, INT_MAX for the cells not reached.</param>
+		void computeDistances(const TraversalProfile& _traversalProfile, int _sourceIndex, bool _isBackward, vector<int>& _distanceList) const;
+	};
+
+}
+
+#endif
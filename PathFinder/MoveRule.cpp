@@ -0,0 +1,38 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "MoveRule.h"
+
+#include "PathParam.h"
+
+
+namespace fournier
+{
+
+	MoveRule::MoveRule(const PathParam* _parameters)
+	{
+		// An empty list allows every type of cube
+		walkableTypeMask = 0;
+		if (_parameters->walkableCubeTypeList.empty())
+			walkableTypeMask = ~0u;
+		for (auto it = _parameters->walkableCubeTypeList.begin(); it != _parameters->walkableCubeTypeList.end(); ++it)
+			walkableTypeMask |= 1u << (*it);
+		walkableTypeMask &= ~(1u << CUBE_AIR);
+
+		maximumJumpHeight = _parameters->maximumJumpHeight;
+		maximumFallHeight = _parameters->maximumFallHeight;
+	}
+
+	MoveRule::MoveRule(unsigned int _walkableTypeMask, int _maximumJumpHeight, int _maximumFallHeight)
+		: walkableTypeMask(_walkableTypeMask), maximumJumpHeight(_maximumJumpHeight), maximumFallHeight(_maximumFallHeight)
+	{
+	}
+
+}
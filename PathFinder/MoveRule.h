@@ -0,0 +1,76 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __MOVE_RULE_H__
+#define __MOVE_RULE_H__
+
+#include "PathFinderConfig.h"
+#include "NavigationGrid.h"
+
+namespace fournier
+{
+	struct PathParam;
+
+	/// <summary>
+	/// Moves allowed to a search, built from its PathParam so a move is checked without going through the list of walkable types.
+	/// Two searches with the same rule walk on the same cells, whatever their start and end positions.
+	/// </summary>
+	struct MoveRule
+	{
+		/// <summary>Cost of a move to one of the 4 direct neighbours, the costs of the searches are fixed-point integers in this unit.</summary>
+		static const int COST_STRAIGHT = 256;
+
+		/// <summary>Cost of a diagonal move, sqrt(2) in fixed-point.</summary>
+		static const int COST_DIAGONAL = 362;
+
+		/// <summary>Bit (1 << type) set for each type of cube that can be walked on, never set for CUBE_AIR.</summary>
+		unsigned int walkableTypeMask;
+
+		int maximumJumpHeight;
+		int maximumFallHeight;
+
+		MoveRule(const PathParam* _parameters);
+
+		MoveRule(unsigned int _walkableTypeMask, int _maximumJumpHeight, int _maximumFallHeight);
+
+		inline bool operator==(const MoveRule& _other) const
+		{
+			return walkableTypeMask == _other.walkableTypeMask &&
+				maximumJumpHeight == _other.maximumJumpHeight &&
+				maximumFallHeight == _other.maximumFallHeight;
+		}
+
+		/// <summary>
+		/// Indicate if a search can stand on a cell, using the obstacles and types of cube.
+		/// </summary>
+		inline bool isWalkable(const NavigationCell& _cell) const
+		{
+			return !(_cell.flags & NavigationGrid::CELL_OBSTACLE) && (walkableTypeMask & (1u << _cell.type));
+		}
+
+		/// <summary>
+		/// Indicate if a search can walk from a cell to one of its neighbours, using the obstacles, types of cube and heights.
+		/// </summary>
+		inline bool canMove(const NavigationGrid& _grid, int _fromIndex, int _toIndex) const
+		{
+			const NavigationCell& cell = _grid.cell(_toIndex);
+
+			if (!isWalkable(cell))
+				return false;
+
+			// The neightbour is too high or too low
+			int heightDifference = cell.height - _grid.getHeight(_fromIndex);
+			return heightDifference <= maximumFallHeight && -heightDifference <= maximumJumpHeight;
+		}
+	};
+
+}
+
+#endif
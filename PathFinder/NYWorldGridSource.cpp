@@ -0,0 +1,74 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "NYWorldGridSource.h"
+
+#ifndef PATHFINDER_HEADLESS
+
+#include "../chunk.h"
+#include "../cube.h"
+#include "../world.h"
+
+
+namespace fournier
+{
+
+	NYWorldGridSource::NYWorldGridSource(NYWorld* _world)
+		: mWorld(_world)
+	{
+	}
+
+	void NYWorldGridSource::readColumns(int _x, int _y, int _width, int _depth, int* _heightList, NYCubeType* _typeList) const
+	{
+		const int chunkSize = NYChunk::CHUNK_SIZE;
+
+		for (int j = 0; j < _depth; ++j)
+		{
+			for (int i = 0; i < _width; ++i)
+			{
+				int n = i + j * _width;
+				int x = _x + i;
+				int y = _y + j;
+
+				_heightList[n] = 0;
+				_typeList[n] = CUBE_AIR;
+
+				if (x < 0 || x >= MAT_SIZE_CUBES || y < 0 || y >= MAT_SIZE_CUBES)
+					continue;
+
+				// Search the topmost cube of the column in the cubes of its chunks, from the highest chunk down
+				int chunkX = x / chunkSize;
+				int chunkY = y / chunkSize;
+				int cubeX = x % chunkSize;
+				int cubeY = y % chunkSize;
+				bool isFound = false;
+
+				for (int chunkZ = MAT_HEIGHT - 1; chunkZ >= 0 && !isFound; --chunkZ)
+				{
+					const NYChunk* chunk = mWorld->_Chunks[chunkX][chunkY][chunkZ];
+					for (int cubeZ = chunkSize - 1; cubeZ >= 0; --cubeZ)
+					{
+						NYCubeType type = chunk->_Cubes[cubeX][cubeY][cubeZ]._Type;
+						if (type == CUBE_AIR)
+							continue;
+
+						_heightList[n] = chunkZ * chunkSize + cubeZ;
+						_typeList[n] = type;
+						isFound = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __NY_WORLD_GRID_SOURCE_H__
+#define __NY_WORLD_GRID_SOURCE_H__
+
+#ifndef PATHFINDER_HEADLESS
+
+#include "GridSource.h"
+
+class NYWorld;
+
+namespace fournier
+{
+	/// <summary>
+	/// GridSource reading the columns of a NYWorld of the MyNecraft engine.
+	/// </summary>
+	class NYWorldGridSource : public GridSource
+	{
+
+	private:
+
+		/// <summary>World read by this source.</summary>
+		NYWorld* mWorld;
+
+
+	public:
+
+		/// <param name="_world">World read by this source, it must stay alive as long as the source is used.</param>
+		NYWorldGridSource(NYWorld* _world);
+
+		virtual void readColumns(int _x, int _y, int _width, int _depth, int* _heightList, NYCubeType* _typeList) const;
+	};
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,201 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "NavigationGrid.h"
+
+#include <algorithm>
+
+
+namespace fournier
+{
+	const int NavigationGrid::NEIGHBOUR_X[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+	const int NavigationGrid::NEIGHBOUR_Y[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+	int NavigationGrid::mSizeX = 0;
+	int NavigationGrid::mSizeY = 0;
+	int NavigationGrid::mNumberPageX = 0;
+	int NavigationGrid::mNumberPageY = 0;
+	int NavigationGrid::mPageRowShift = 0;
+	NavigationGrid::NeighbourOffsetTable NavigationGrid::mNeighbourOffsetTable;
+
+	NavigationGrid::NavigationGrid()
+		: mCellList(nullptr), mNumberLoadedPage(0)
+	{
+	}
+
+	int NavigationGrid::getNumberIndex(int _sizeX, int _sizeY)
+	{
+		int numberPageX = (_sizeX + PAGE_SIZE - 1) / PAGE_SIZE;
+		int numberPageY = (_sizeY + PAGE_SIZE - 1) / PAGE_SIZE;
+		if (numberPageY == 0)
+			return 0;
+		return (((numberPageY - 1) << getPageRowShift(numberPageX)) + numberPageX) * PAGE_AREA;
+	}
+
+	int NavigationGrid::getPageRowShift(int _numberPageX)
+	{
+		// The rows of pages are padded to a power of 2, so the position of a page is found with shifts
+		int pageRowShift = 0;
+		while ((1 << pageRowShift) < _numberPageX)
+			++pageRowShift;
+		return pageRowShift;
+	}
+
+	void NavigationGrid::setSize(int _sizeX, int _sizeY)
+	{
+		mSizeX = _sizeX;
+		mSizeY = _sizeY;
+		mNumberPageX = (_sizeX + PAGE_SIZE - 1) / PAGE_SIZE;
+		mNumberPageY = (_sizeY + PAGE_SIZE - 1) / PAGE_SIZE;
+		mPageRowShift = getPageRowShift(mNumberPageX);
+
+		// The offsets of each position in a page are measured on a cell of the second page of the second row,
+		// the indexes grow in the same way on the whole map so they are the same everywhere
+		static const int POSITION_LIST[3] = { 0, 1, PAGE_SIZE - 1 };
+		for (int row = 0; row < 3; ++row)
+		{
+			for (int column = 0; column < 3; ++column)
+			{
+				int x = PAGE_SIZE + POSITION_LIST[column];
+				int y = PAGE_SIZE + POSITION_LIST[row];
+				for (int direction = 0; direction < 8; ++direction)
+					mNeighbourOffsetTable.offsetList[column + row * 3][direction] = index(x + NEIGHBOUR_X[direction], y + NEIGHBOUR_Y[direction]) - index(x, y);
+			}
+		}
+	}
+
+	void NavigationGrid::initialize(int _sizeX, int _sizeY)
+	{
+		setSize(_sizeX, _sizeY);
+
+		// The cells are only given memory when their page is loaded
+		mOwnedCellList.assign(getNumberIndex());
+		mCellList = mOwnedCellList.data();
+
+		mPageStateList.assign(getNumberPage(), 0);
+		mNumberLoadedPage = 0;
+	}
+
+	void NavigationGrid::attach(int _sizeX, int _sizeY, NavigationCell* _cellList)
+	{
+		setSize(_sizeX, _sizeY);
+
+		mOwnedCellList.clear();
+		mCellList = _cellList;
+
+		mPageStateList.assign(getNumberPage(), 0);
+		mNumberLoadedPage = 0;
+		for (int pageY = 0; pageY < mNumberPageY; ++pageY)
+			for (int pageX = 0; pageX < mNumberPageX; ++pageX)
+				setPageLoaded(getPage(pageX, pageY));
+	}
+
+	void NavigationGrid::clear()
+	{
+		mOwnedCellList.clear();
+		mCellList = nullptr;
+		mPageStateList.clear();
+		mNumberLoadedPage = 0;
+	}
+
+	void NavigationGrid::setColumns(int _x, int _y, int _width, int _depth, const int* _heightList, const NYCubeType* _typeList)
+	{
+		for (int j = 0; j < _depth; ++j)
+		{
+			for (int i = 0; i < _width; ++i)
+			{
+				if (!isInRange(_x + i, _y + j))
+					continue;
+
+				NavigationCell& cell = mCellList[index(_x + i, _y + j)];
+				cell.height = (short)_heightList[i + j * _width];
+				cell.type = (unsigned char)_typeList[i + j * _width];
+			}
+		}
+	}
+
+	size_t NavigationGrid::getMemorySize() const
+	{
+		if (mOwnedCellList.empty())
+			return 0;
+		return (size_t)mNumberLoadedPage * PAGE_AREA * sizeof(NavigationCell);
+	}
+
+	void NavigationGrid::setPageLoaded(int _page)
+	{
+		if (isPageLoaded(_page))
+			return;
+
+		mPageStateList[_page] |= PAGE_LOADED;
+		++mNumberLoadedPage;
+
+		// The page may complete the pages around it
+		int pageX = getPageX(_page);
+		int pageY = getPageY(_page);
+		for (int y = pageY - 1; y <= pageY + 1; ++y)
+			for (int x = pageX - 1; x <= pageX + 1; ++x)
+				updatePageReady(x, y);
+	}
+
+	void NavigationGrid::unloadPage(int _page)
+	{
+		if (!isPageLoaded(_page) || mOwnedCellList.empty())
+			return;
+
+		mOwnedCellList.discard((size_t)_page * PAGE_AREA, PAGE_AREA);
+
+		mPageStateList[_page] &= ~PAGE_LOADED;
+		--mNumberLoadedPage;
+
+		int pageX = getPageX(_page);
+		int pageY = getPageY(_page);
+		for (int y = pageY - 1; y <= pageY + 1; ++y)
+			for (int x = pageX - 1; x <= pageX + 1; ++x)
+				updatePageReady(x, y);
+	}
+
+	bool NavigationGrid::hasObstacleInPage(int _page) const
+	{
+		const NavigationCell* cellList = mCellList + (size_t)_page * PAGE_AREA;
+		for (int n = 0; n < PAGE_AREA; ++n)
+		{
+			if ((cellList[n].flags & CELL_OBSTACLE) != 0)
+				return true;
+		}
+		return false;
+	}
+
+	void NavigationGrid::getPageBounds(int _page, int& _x, int& _y, int& _width, int& _depth)
+	{
+		_x = getPageX(_page) * PAGE_SIZE;
+		_y = getPageY(_page) * PAGE_SIZE;
+		_width = (_x + PAGE_SIZE <= mSizeX) ? PAGE_SIZE : mSizeX - _x;
+		_depth = (_y + PAGE_SIZE <= mSizeY) ? PAGE_SIZE : mSizeY - _y;
+	}
+
+	void NavigationGrid::updatePageReady(int _pageX, int _pageY)
+	{
+		if (_pageX < 0 || _pageX >= mNumberPageX || _pageY < 0 || _pageY >= mNumberPageY)
+			return;
+
+		// The pages outside the map have no cells to wait for
+		bool isReady = isPageLoaded(getPage(_pageX, _pageY));
+		for (int y = max(0, _pageY - 1); y <= min(mNumberPageY - 1, _pageY + 1) && isReady; ++y)
+			for (int x = max(0, _pageX - 1); x <= min(mNumberPageX - 1, _pageX + 1) && isReady; ++x)
+				isReady = isPageLoaded(getPage(x, y));
+
+		int page = getPage(_pageX, _pageY);
+		if (isReady)
+			mPageStateList[page] |= PAGE_READY;
+		else
+			mPageStateList[page] &= ~PAGE_READY;
+	}
+
+}
@@ -0,0 +1,287 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __NAVIGATION_GRID_H__
+#define __NAVIGATION_GRID_H__
+
+#include <vector>
+#include "PathFinderConfig.h"
+#include "SparseArray.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// Static data of one cell of the 2D map, packed so that everything the search reads about a neighbour is in one place.
+	/// </summary>
+	struct NavigationCell
+	{
+		/// <summary>Height of the topmost cube of the column.</summary>
+		short height;
+
+		/// <summary>Type of the topmost cube of the column, a NYCubeType.</summary>
+		unsigned char type;
+
+		/// <summary>Combination of the NavigationGrid::CELL_ flags.</summary>
+		unsigned char flags;
+	};
+
+	/// <summary>
+	/// Internal 2D representation of the world used by the PathFinder, one cell per column of the voxel world.
+	///
+	/// The size of the map is chosen when it is initialized. The map is made of square pages of PAGE_SIZE cells, which are read from the world
+	/// one at a time (see PathFinder::setLazyLoading()) and whose cells are stored together: the pages are placed row by row, and the cells row by row inside their page.
+	/// A row of pages is given a power of 2 number of pages, so a position is found back from an index with shifts.
+	/// The cells of a page never loaded do not take any memory.
+	///
+	/// The PathFinder has a single map, its size is shared by every structure built on it and by the static functions below.
+	/// </summary>
+	class NavigationGrid
+	{
+
+	public:
+
+		/// <summary>Flag of a cell marked as an obstacle with PathFinder::setObstacle().</summary>
+		static const unsigned char CELL_OBSTACLE = 1;
+
+		/// <summary>Relative position of the 8 neighbours of a cell, the diagonal directions have an odd index.</summary>
+		static const int NEIGHBOUR_X[8];
+		static const int NEIGHBOUR_Y[8];
+
+		/// <summary>Side of the pages, see PATHFINDER_PAGE_SIZE.</summary>
+		static const int PAGE_SIZE = PATHFINDER_PAGE_SIZE;
+
+		/// <summary>Number of cells of a page, the index of the first cell of a page is a multiple of it.</summary>
+		static const int PAGE_AREA = PAGE_SIZE * PAGE_SIZE;
+
+		static_assert((PAGE_SIZE & (PAGE_SIZE - 1)) == 0 && PAGE_SIZE >= 8, "PATHFINDER_PAGE_SIZE must be a power of 2 of at least 8");
+
+
+	private:
+
+		/// <summary>Flags of a page in mPageStateList.</summary>
+		static const unsigned char PAGE_LOADED = 1;
+		static const unsigned char PAGE_READY = 2;
+
+		/// <summary>
+		/// Difference between the index of a cell and the ones of its 8 neighbours, for each position of the cell in its page, see getNeighbourOffsetList().
+		/// </summary>
+		struct NeighbourOffsetTable
+		{
+			alignas(32) int offsetList[9][8];
+		};
+
+		/// <summary>Size of the map in cells.</summary>
+		static int mSizeX;
+		static int mSizeY;
+
+		/// <summary>Number of pages on each side of the map, the last ones can be partly outside of it.</summary>
+		static int mNumberPageX;
+		static int mNumberPageY;
+
+		/// <summary>A row of pages holds 1 << mPageRowShift pages, the ones after mNumberPageX are never used.</summary>
+		static int mPageRowShift;
+
+		static NeighbourOffsetTable mNeighbourOffsetTable;
+
+		/// <summary>Cells of the map, the cell (x, y) is at the index given by index().</summary>
+		NavigationCell* mCellList;
+
+		/// <summary>Cells allocated by initialize(), empty when the cells are the ones of a snapshot.</summary>
+		SparseArray<NavigationCell> mOwnedCellList;
+
+		/// <summary>PAGE_LOADED and PAGE_READY flags of each page.</summary>
+		vector<unsigned char> mPageStateList;
+
+		/// <summary>Number of pages of the map with the flag PAGE_LOADED.</summary>
+		int mNumberLoadedPage;
+
+
+	public:
+
+		NavigationGrid();
+
+		/// <summary>
+		/// Give its size to the map and allocate its cells. Every cell is empty and every page is unloaded.
+		/// </summary>
+		void initialize(int _sizeX, int _sizeY);
+
+		/// <summary>
+		/// Use cells stored elsewhere instead of allocating them, see NavigationSnapshot. They are not copied and must stay valid until clear().
+		/// Every page is loaded.
+		/// </summary>
+		/// <param name="_sizeX">Size of the map on the X axis.</param>
+		/// <param name="_sizeY">Size of the map on the Y axis.</param>
+		/// <param name="_cellList">getNumberIndex() cells, in the order of index().</param>
+		void attach(int _sizeX, int _sizeY, NavigationCell* _cellList);
+
+		/// <summary>
+		/// Free the cells.
+		/// </summary>
+		void clear();
+
+		/// <summary>
+		/// Set the topmost cube of a rectangle of columns, the lists are given row by row like in GridSource::readColumns().
+		/// </summary>
+		void setColumns(int _x, int _y, int _width, int _depth, const int* _heightList, const NYCubeType* _typeList);
+
+		/// <summary>
+		/// Number of bytes used by the cells of the loaded pages, the cells of a snapshot are not counted.
+		/// </summary>
+		size_t getMemorySize() const;
+
+
+		//////// Pages ////////
+
+		/// <summary>
+		/// Mark a page as loaded, once its cells have been set with setColumns().
+		/// </summary>
+		void setPageLoaded(int _page);
+
+		/// <summary>
+		/// Empty the cells of a loaded page and give back their memory. The obstacles of the page are lost.
+		/// </summary>
+		void unloadPage(int _page);
+
+		/// <summary>
+		/// Indicate if some cells of a page are marked as obstacles.
+		/// </summary>
+		bool hasObstacleInPage(int _page) const;
+
+		inline bool isPageLoaded(int _page) const { return (mPageStateList[_page] & PAGE_LOADED) != 0; }
+
+		/// <summary>
+		/// Indicate if a page and the pages around it are loaded, so the moves from every cell of the page are known.
+		/// </summary>
+		inline bool isPageReady(int _page) const { return (mPageStateList[_page] & PAGE_READY) != 0; }
+
+		inline int getNumberLoadedPage() const { return mNumberLoadedPage; }
+
+		/// <summary>
+		/// Indicate if every page of the map is loaded.
+		/// </summary>
+		inline bool isComplete() const { return mNumberLoadedPage == mNumberPageX * mNumberPageY; }
+
+		/// <summary>
+		/// Page holding a cell.
+		/// </summary>
+		inline static int getPage(int _index) { return _index / PAGE_AREA; }
+
+		inline static int getPage(int _pageX, int _pageY) { return _pageX + (_pageY << mPageRowShift); }
+
+		inline static int getPageX(int _page) { return _page & ((1 << mPageRowShift) - 1); }
+
+		inline static int getPageY(int _page) { return _page >> mPageRowShift; }
+
+		inline static int getNumberPageX() { return mNumberPageX; }
+
+		inline static int getNumberPageY() { return mNumberPageY; }
+
+		/// <summary>
+		/// Number of page indexes, including the ones at the end of the rows of pages that are outside of the map.
+		/// </summary>
+		inline static int getNumberPage() { return (mNumberPageY > 0) ? ((mNumberPageY - 1) << mPageRowShift) + mNumberPageX : 0; }
+
+		/// <summary>
+		/// Rectangle of the cells of a page inside the map.
+		/// </summary>
+		static void getPageBounds(int _page, int& _x, int& _y, int& _width, int& _depth);
+
+
+		//////// Cells ////////
+
+		inline static int getSizeX() { return mSizeX; }
+
+		inline static int getSizeY() { return mSizeY; }
+
+		/// <summary>
+		/// Number of indexes of the map, the size of the lists holding a value for each cell.
+		/// Some of them are outside of the map, in the last pages of each row and in the unused pages of each row of pages.
+		/// </summary>
+		inline static int getNumberIndex() { return getNumberPage() * PAGE_AREA; }
+
+		/// <summary>
+		/// Number of indexes a map of the given size would have, to check data saved before the map is initialized.
+		/// </summary>
+		static int getNumberIndex(int _sizeX, int _sizeY);
+
+		/// <summary>
+		/// Index of a cell in every list of the map, see the description of the class.
+		/// </summary>
+		inline static int index(int _x, int _y)
+		{
+			return getPage(_x / PAGE_SIZE, _y / PAGE_SIZE) * PAGE_AREA + (_x % PAGE_SIZE) + (_y % PAGE_SIZE) * PAGE_SIZE;
+		}
+
+		inline static int getX(int _index)
+		{
+			return getPageX(_index / PAGE_AREA) * PAGE_SIZE + _index % PAGE_SIZE;
+		}
+
+		inline static int getY(int _index)
+		{
+			return getPageY(_index / PAGE_AREA) * PAGE_SIZE + (_index % PAGE_AREA) / PAGE_SIZE;
+		}
+
+		/// <summary>
+		/// Difference between the index of a cell and the ones of its 8 neighbours, in the order of NEIGHBOUR_X.
+		/// The neighbours outside the map get an offset too, it must not be used for them.
+		/// </summary>
+		inline static const int* getNeighbourOffsetList(int _index)
+		{
+			// The offsets only change on the first and last column and row of a page, where the neighbours are in the next pages
+			int localX = _index % PAGE_SIZE;
+			int localY = (_index % PAGE_AREA) / PAGE_SIZE;
+			int column = (localX == 0) ? 0 : ((localX == PAGE_SIZE - 1) ? 2 : 1);
+			int row = (localY == 0) ? 0 : ((localY == PAGE_SIZE - 1) ? 2 : 1);
+			return mNeighbourOffsetTable.offsetList[column + row * 3];
+		}
+
+		inline static bool isInRange(int _x, int _y) { return _x >= 0 && _x < mSizeX && _y >= 0 && _y < mSizeY; }
+
+		inline const NavigationCell& cell(int _index) const { return mCellList[_index]; }
+
+		inline int getHeight(int _index) const { return mCellList[_index].height; }
+
+		inline NYCubeType getType(int _index) const { return (NYCubeType)mCellList[_index].type; }
+
+		inline bool hasObstacle(int _index) const { return (mCellList[_index].flags & CELL_OBSTACLE) != 0; }
+
+		inline void setObstacle(int _index, bool _hasObstacle)
+		{
+			if (_hasObstacle)
+				mCellList[_index].flags |= CELL_OBSTACLE;
+			else
+				mCellList[_index].flags &= ~CELL_OBSTACLE;
+		}
+
+
+	private:
+
+		/// <summary>
+		/// Compute the layout of the pages and the neighbour offsets for a size of map.
+		/// </summary>
+		static void setSize(int _sizeX, int _sizeY);
+
+		/// <summary>
+		/// Shift giving the index of the first page of a row of pages from its Y.
+		/// </summary>
+		static int getPageRowShift(int _numberPageX);
+
+		/// <summary>
+		/// Set the PAGE_READY flag of a page from the state of the pages around it.
+		/// </summary>
+		void updatePageReady(int _pageX, int _pageY);
+	};
+
+}
+
+#endif
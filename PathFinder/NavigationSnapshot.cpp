@@ -0,0 +1,388 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "NavigationSnapshot.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace fournier
+{
+	/// <summary>Kind of data held by a section of the file.</summary>
+	enum SnapshotSectionType
+	{
+		SECTION_CELLS,
+		SECTION_MOVE_MASKS,
+		SECTION_COMPONENTS
+	};
+
+	/// <summary>
+	/// Start of the file. Every value is written with the byte order of the machine, SNAPSHOT_BYTE_ORDER rejects the files of another one.
+	/// </summary>
+	struct SnapshotHeader
+	{
+		char magic[8];
+		unsigned int formatVersion;
+		unsigned int byteOrder;
+		int sizeX;
+		int sizeY;
+		int cellSize;
+		unsigned long long worldVersion;
+		unsigned long long fileSize;
+
+		/// <summary>Checksum of everything after the header.</summary>
+		unsigned long long checksum;
+
+		unsigned int numberSection;
+
+		/// <summary>PATHFINDER_PAGE_SIZE, the cells and the data derived from them are stored in the order of NavigationGrid::index().</summary>
+		int pageSize;
+	};
+
+	/// <summary>
+	/// Description of one block of data, the sections follow the header.
+	/// </summary>
+	struct SnapshotSection
+	{
+		unsigned int type;
+
+		/// <summary>MoveRule of the masks or components, see MoveRule.</summary>
+		unsigned int walkableTypeMask;
+		int maximumJumpHeight;
+		int maximumFallHeight;
+
+		/// <summary>The components link the diagonal neighbours.</summary>
+		unsigned int allowDiagonalMovements;
+
+		unsigned int padding;
+
+		/// <summary>Position of the data from the start of the file, a multiple of SECTION_ALIGNMENT.</summary>
+		unsigned long long offset;
+
+		unsigned long long size;
+	};
+
+	static const char SNAPSHOT_MAGIC[8] = { 'P', 'F', 'N', 'A', 'V', 'S', 'N', 'P' };
+
+	static const unsigned int SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+	/// <summary>Alignment of the data of the sections, a cache line.</summary>
+	static const size_t SECTION_ALIGNMENT = 64;
+
+	/// <summary>
+	/// FNV-1a on words of 8 bytes, with the high bits folded back so every bit of the data changes the whole checksum.
+	/// </summary>
+	static unsigned long long computeChecksum(const unsigned char* _data, size_t _size)
+	{
+		unsigned long long checksum = 14695981039346656037ull;
+		size_t n = 0;
+		for (; n + 8 <= _size; n += 8)
+		{
+			unsigned long long word;
+			memcpy(&word, _data + n, 8);
+			checksum = (checksum ^ word) * 1099511628211ull;
+			checksum ^= checksum >> 29;
+		}
+		for (; n < _size; ++n)
+			checksum = (checksum ^ _data[n]) * 1099511628211ull;
+		return checksum;
+	}
+
+	/// <summary>
+	/// Size the data of a section must have, for a map with _numberIndex indexes.
+	/// </summary>
+	static size_t getSectionSize(unsigned int _type, size_t _numberIndex)
+	{
+		if (_type == SECTION_CELLS)
+			return _numberIndex * sizeof(NavigationCell);
+		if (_type == SECTION_MOVE_MASKS)
+			return _numberIndex * sizeof(unsigned char);
+		return _numberIndex * sizeof(int);
+	}
+
+
+	NavigationSnapshot::NavigationSnapshot()
+		: mData(nullptr), mSize(0)
+	{
+	}
+
+	NavigationSnapshot::~NavigationSnapshot()
+	{
+		if (mData == nullptr)
+			return;
+
+#ifdef _WIN32
+		UnmapViewOfFile(mData);
+#else
+		munmap(mData, mSize);
+#endif
+	}
+
+	NavigationSnapshot* NavigationSnapshot::open(const char* _path, unsigned long long _worldVersion, int _sizeX, int _sizeY)
+	{
+		NavigationSnapshot* snapshot = new NavigationSnapshot();
+		if (!snapshot->mapFile(_path) || !snapshot->isValid(_worldVersion, _sizeX, _sizeY))
+		{
+			delete snapshot;
+			return nullptr;
+		}
+		return snapshot;
+	}
+
+	bool NavigationSnapshot::save(const char* _path, unsigned long long _worldVersion, const NavigationGrid& _grid,
+		const vector<TraversalProfile*>& _profileList, const vector<ComponentMap*>& _componentMapList)
+	{
+		size_t numberIndex = NavigationGrid::getNumberIndex();
+		vector<SnapshotSection> sectionList;
+		SnapshotSection section;
+		memset(&section, 0, sizeof(section));
+
+		section.type = SECTION_CELLS;
+		sectionList.push_back(section);
+
+		vector<const TraversalProfile*> storedProfileList;
+		for (auto it = _profileList.begin(); it != _profileList.end(); ++it)
+		{
+			if ((*it)->isDirty())
+				continue;
+
+			section.type = SECTION_MOVE_MASKS;
+			section.walkableTypeMask = (*it)->getMoveRule().walkableTypeMask;
+			section.maximumJumpHeight = (*it)->getMoveRule().maximumJumpHeight;
+			section.maximumFallHeight = (*it)->getMoveRule().maximumFallHeight;
+			section.allowDiagonalMovements = 0;
+			sectionList.push_back(section);
+			storedProfileList.push_back(*it);
+		}
+
+		vector<ComponentMap*> storedComponentMapList;
+		for (auto it = _componentMapList.begin(); it != _componentMapList.end(); ++it)
+		{
+			if ((*it)->isDirty())
+				continue;
+
+			section.type = SECTION_COMPONENTS;
+			section.walkableTypeMask = (*it)->getMoveRule().walkableTypeMask;
+			section.maximumJumpHeight = (*it)->getMoveRule().maximumJumpHeight;
+			section.maximumFallHeight = (*it)->getMoveRule().maximumFallHeight;
+			section.allowDiagonalMovements = (*it)->allowsDiagonalMovements() ? 1 : 0;
+			sectionList.push_back(section);
+			storedComponentMapList.push_back(*it);
+		}
+
+		// The data of the sections follow their descriptions, each one aligned
+		size_t offset = sizeof(SnapshotHeader) + sectionList.size() * sizeof(SnapshotSection);
+		for (auto it = sectionList.begin(); it != sectionList.end(); ++it)
+		{
+			offset = (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+			it->offset = offset;
+			it->size = getSectionSize(it->type, numberIndex);
+			offset += (size_t)it->size;
+		}
+
+		vector<unsigned char> buffer(offset, 0);
+		memcpy(&buffer[sizeof(SnapshotHeader)], sectionList.data(), sectionList.size() * sizeof(SnapshotSection));
+		memcpy(&buffer[(size_t)sectionList[0].offset], &_grid.cell(0), (size_t)sectionList[0].size);
+
+		for (size_t n = 0; n < storedProfileList.size(); ++n)
+		{
+			unsigned char* moveMaskList = &buffer[(size_t)sectionList[1 + n].offset];
+			for (size_t index = 0; index < numberIndex; ++index)
+				moveMaskList[index] = storedProfileList[n]->getMoveMask((int)index);
+		}
+
+		// The roots are stored, so the components are read without following the trees
+		for (size_t n = 0; n < storedComponentMapList.size(); ++n)
+		{
+			int* componentList = (int*)&buffer[(size_t)sectionList[1 + storedProfileList.size() + n].offset];
+			for (size_t index = 0; index < numberIndex; ++index)
+				componentList[index] = storedComponentMapList[n]->getComponent((int)index);
+		}
+
+		SnapshotHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+		header.formatVersion = FORMAT_VERSION;
+		header.byteOrder = SNAPSHOT_BYTE_ORDER;
+		header.sizeX = NavigationGrid::getSizeX();
+		header.sizeY = NavigationGrid::getSizeY();
+		header.pageSize = NavigationGrid::PAGE_SIZE;
+		header.cellSize = sizeof(NavigationCell);
+		header.worldVersion = _worldVersion;
+		header.fileSize = buffer.size();
+		header.checksum = computeChecksum(&buffer[sizeof(SnapshotHeader)], buffer.size() - sizeof(SnapshotHeader));
+		header.numberSection = (unsigned int)sectionList.size();
+		memcpy(&buffer[0], &header, sizeof(header));
+
+		string temporaryPath = string(_path) + ".tmp";
+		FILE* file = fopen(temporaryPath.c_str(), "wb");
+		if (file == nullptr)
+			return false;
+
+		bool isWritten = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+		isWritten = (fclose(file) == 0) && isWritten;
+		if (!isWritten)
+		{
+			remove(temporaryPath.c_str());
+			return false;
+		}
+
+		remove(_path);
+		return rename(temporaryPath.c_str(), _path) == 0;
+	}
+
+	NavigationCell* NavigationSnapshot::getCellList() const
+	{
+		const SnapshotHeader* header = (const SnapshotHeader*)mData;
+		const SnapshotSection* sectionList = (const SnapshotSection*)(mData + sizeof(SnapshotHeader));
+		for (unsigned int n = 0; n < header->numberSection; ++n)
+			if (sectionList[n].type == SECTION_CELLS)
+				return (NavigationCell*)(mData + sectionList[n].offset);
+		return nullptr;
+	}
+
+	void NavigationSnapshot::createTraversalProfiles(vector<TraversalProfile*>& _profileList) const
+	{
+		const SnapshotHeader* header = (const SnapshotHeader*)mData;
+		const SnapshotSection* sectionList = (const SnapshotSection*)(mData + sizeof(SnapshotHeader));
+		for (unsigned int n = 0; n < header->numberSection; ++n)
+		{
+			const SnapshotSection& section = sectionList[n];
+			if (section.type != SECTION_MOVE_MASKS)
+				continue;
+
+			TraversalProfile* profile = new TraversalProfile(MoveRule(section.walkableTypeMask, section.maximumJumpHeight, section.maximumFallHeight));
+			profile->attach(mData + section.offset);
+			_profileList.push_back(profile);
+		}
+	}
+
+	void NavigationSnapshot::createComponentMaps(vector<ComponentMap*>& _componentMapList) const
+	{
+		const SnapshotHeader* header = (const SnapshotHeader*)mData;
+		const SnapshotSection* sectionList = (const SnapshotSection*)(mData + sizeof(SnapshotHeader));
+		for (unsigned int n = 0; n < header->numberSection; ++n)
+		{
+			const SnapshotSection& section = sectionList[n];
+			if (section.type != SECTION_COMPONENTS)
+				continue;
+
+			ComponentMap* componentMap = new ComponentMap(MoveRule(section.walkableTypeMask, section.maximumJumpHeight, section.maximumFallHeight), section.allowDiagonalMovements != 0);
+			componentMap->attach((int*)(mData + section.offset));
+			_componentMapList.push_back(componentMap);
+		}
+	}
+
+	bool NavigationSnapshot::mapFile(const char* _path)
+	{
+#ifdef _WIN32
+		HANDLE file = CreateFileA(_path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		// The view keeps the mapping and the file open, their handles are not needed after it is created
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (mapping == nullptr)
+			return false;
+
+		void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+		CloseHandle(mapping);
+		if (data == nullptr)
+			return false;
+
+		mSize = (size_t)size.QuadPart;
+#else
+		int file = ::open(_path, O_RDONLY);
+		if (file < 0)
+			return false;
+
+		struct stat status;
+		if (fstat(file, &status) != 0 || status.st_size <= 0)
+		{
+			close(file);
+			return false;
+		}
+
+		// The mapping stays valid after the file is closed
+		void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+		close(file);
+		if (data == MAP_FAILED)
+			return false;
+
+		mSize = (size_t)status.st_size;
+#endif
+
+		mData = (unsigned char*)data;
+		return true;
+	}
+
+	bool NavigationSnapshot::isValid(unsigned long long _worldVersion, int _sizeX, int _sizeY) const
+	{
+		if (mSize < sizeof(SnapshotHeader))
+			return false;
+
+		const SnapshotHeader* header = (const SnapshotHeader*)mData;
+		if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+			header->formatVersion != FORMAT_VERSION ||
+			header->byteOrder != SNAPSHOT_BYTE_ORDER ||
+			header->sizeX != _sizeX ||
+			header->sizeY != _sizeY ||
+			header->pageSize != NavigationGrid::PAGE_SIZE ||
+			header->cellSize != (int)sizeof(NavigationCell) ||
+			header->worldVersion != _worldVersion ||
+			header->fileSize != mSize)
+			return false;
+
+		if (header->numberSection > (mSize - sizeof(SnapshotHeader)) / sizeof(SnapshotSection))
+			return false;
+
+		size_t numberIndex = (size_t)NavigationGrid::getNumberIndex(_sizeX, _sizeY);
+		int numberCellSection = 0;
+		const SnapshotSection* sectionList = (const SnapshotSection*)(mData + sizeof(SnapshotHeader));
+		for (unsigned int n = 0; n < header->numberSection; ++n)
+		{
+			const SnapshotSection& section = sectionList[n];
+			if (section.type > SECTION_COMPONENTS ||
+				section.size != getSectionSize(section.type, numberIndex) ||
+				section.offset % SECTION_ALIGNMENT != 0 ||
+				section.offset > mSize || section.size > mSize - section.offset)
+				return false;
+
+			if (section.type == SECTION_CELLS)
+				++numberCellSection;
+		}
+
+		if (numberCellSection != 1)
+			return false;
+
+		return computeChecksum(mData + sizeof(SnapshotHeader), mSize - sizeof(SnapshotHeader)) == header->checksum;
+	}
+
+}
@@ -0,0 +1,112 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __NAVIGATION_SNAPSHOT_H__
+#define __NAVIGATION_SNAPSHOT_H__
+
+#include <cstddef>
+#include <vector>
+#include "PathFinderConfig.h"
+#include "NavigationGrid.h"
+#include "TraversalProfile.h"
+#include "ComponentMap.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// File holding the NavigationGrid and the data derived from it (the move masks of the TraversalProfiles and the components of the ComponentMaps),
+	/// so a restarted PathFinder does not read the whole world again.
+	///
+	/// The file is mapped in memory and the grid, masks and components use it directly, they are not copied.
+	/// The mapping is private: the cells changed afterwards (setObstacle() for example) are copied on write and the file is never modified.
+	///
+	/// A snapshot is only used if it has the format, the size of map and the version of the world expected, and if its checksum is right.
+	/// The version of the world is chosen by the user, any value that changes when the world changes.
+	/// </summary>
+	class NavigationSnapshot
+	{
+
+	public:
+
+		/// <summary>Version of the format of the file, changed each time the layout of the file or of the stored data changes.</summary>
+		static const unsigned int FORMAT_VERSION = 3;
+
+
+	private:
+
+		/// <summary>Start of the mapped file.</summary>
+		unsigned char* mData;
+
+		/// <summary>Size of the file in bytes.</summary>
+		size_t mSize;
+
+
+	public:
+
+		~NavigationSnapshot();
+
+		/// <summary>
+		/// Map a snapshot and check it.
+		/// </summary>
+		/// <param name="_path">Path of the file.</param>
+		/// <param name="_worldVersion">Version of the world the snapshot must have been saved with.</param>
+		/// <param name="_sizeX">Size of the map the snapshot must have, on the X axis.</param>
+		/// <param name="_sizeY">Size of the map the snapshot must have, on the Y axis.</param>
+		/// <returns>The snapshot, or nullptr if the file does not exist, is stale or is corrupted.</returns>
+		static NavigationSnapshot* open(const char* _path, unsigned long long _worldVersion, int _sizeX, int _sizeY);
+
+		/// <summary>
+		/// Write a snapshot, in a temporary file first so an existing snapshot is only replaced by a complete one.
+		/// </summary>
+		/// <param name="_path">Path of the file.</param>
+		/// <param name="_worldVersion">Version of the world the grid was read from.</param>
+		/// <param name="_grid">Cells of the map.</param>
+		/// <param name="_profileList">Profiles to store, the dirty ones are skipped.</param>
+		/// <param name="_componentMapList">Component maps to store, the dirty ones are skipped.</param>
+		/// <returns>False if the file could not be written.</returns>
+		static bool save(const char* _path, unsigned long long _worldVersion, const NavigationGrid& _grid,
+			const vector<TraversalProfile*>& _profileList, const vector<ComponentMap*>& _componentMapList);
+
+		/// <summary>
+		/// Cells of the map, to give to NavigationGrid::attach().
+		/// </summary>
+		NavigationCell* getCellList() const;
+
+		/// <summary>
+		/// Create the profiles stored in the snapshot, their masks are the ones of the snapshot.
+		/// </summary>
+		void createTraversalProfiles(vector<TraversalProfile*>& _profileList) const;
+
+		/// <summary>
+		/// Create the component maps stored in the snapshot, their components are the ones of the snapshot.
+		/// </summary>
+		void createComponentMaps(vector<ComponentMap*>& _componentMapList) const;
+
+
+	private:
+
+		NavigationSnapshot();
+
+		/// <summary>
+		/// Map the file in memory, copied on write.
+		/// </summary>
+		bool mapFile(const char* _path);
+
+		/// <summary>
+		/// Check the header, the sections and the checksum of the mapped file.
+		/// </summary>
+		bool isValid(unsigned long long _worldVersion, int _sizeX, int _sizeY) const;
+	};
+
+}
+
+#endif
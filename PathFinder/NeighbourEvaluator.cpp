@@ -0,0 +1,220 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "NeighbourEvaluator.h"
+
+#include "MoveRule.h"
+#include "NodeRecord.h"
+
+#ifdef PATHFINDER_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define PATHFINDER_TARGET_SSE4
+#define PATHFINDER_TARGET_AVX2
+#else
+#define PATHFINDER_TARGET_SSE4 __attribute__((target("sse4.1")))
+#define PATHFINDER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+
+namespace fournier
+{
+	/// <summary>Cost of the move in each direction.</summary>
+	alignas(32) static const int COST_LIST[8] =
+	{
+		MoveRule::COST_STRAIGHT, MoveRule::COST_DIAGONAL, MoveRule::COST_STRAIGHT, MoveRule::COST_DIAGONAL,
+		MoveRule::COST_STRAIGHT, MoveRule::COST_DIAGONAL, MoveRule::COST_STRAIGHT, MoveRule::COST_DIAGONAL
+	};
+
+	/// <summary>Bit of each direction in a move mask.</summary>
+	alignas(32) static const int BIT_LIST[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+
+	/// <summary>Flags of the stamp of a record.</summary>
+	static const unsigned int NODE_OPEN = NodeRecord::STAMP_OPEN;
+	static const unsigned int NODE_CLOSED = NodeRecord::STAMP_CLOSED;
+
+	/// <summary>Number of integers in a record.</summary>
+	static const int RECORD_SIZE = NodeRecord::SIZE;
+
+	static_assert(sizeof(NodeRecord) == RECORD_SIZE * sizeof(int), "The records are read as RECORD_SIZE integers");
+
+	/// <summary>Position of the G value and of the stamp in a record.</summary>
+	static const int G_OFFSET = NodeRecord::G_OFFSET;
+	static const int STAMP_OFFSET = NodeRecord::STAMP_OFFSET;
+
+
+	InstructionSet NeighbourEvaluator::getBestInstructionSet()
+	{
+#ifdef PATHFINDER_SIMD
+		static const InstructionSet BEST_INSTRUCTION_SET = []()
+		{
+#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 0);
+			int maximumLeaf = info[0];
+
+			// AVX2 also needs the system to save the AVX registers
+			__cpuid(info, 1);
+			bool hasSSE4 = (info[2] & (1 << 19)) != 0;
+			bool hasAVX = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+			bool hasAVX2 = false;
+			if (hasAVX && maximumLeaf >= 7)
+			{
+				__cpuidex(info, 7, 0);
+				hasAVX2 = (info[1] & (1 << 5)) != 0;
+			}
+#else
+			__builtin_cpu_init();
+			bool hasSSE4 = __builtin_cpu_supports("sse4.1") != 0;
+			bool hasAVX2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+			if (hasAVX2)
+				return INSTRUCTION_SET_AVX2;
+			if (hasSSE4)
+				return INSTRUCTION_SET_SSE4;
+			return INSTRUCTION_SET_SCALAR;
+		}();
+
+		return BEST_INSTRUCTION_SET;
+#else
+		return INSTRUCTION_SET_SCALAR;
+#endif
+	}
+
+	NeighbourEvaluator::EvaluateFunction NeighbourEvaluator::getEvaluateFunction(InstructionSet _instructionSet)
+	{
+#ifdef PATHFINDER_SIMD
+		InstructionSet bestInstructionSet = getBestInstructionSet();
+		InstructionSet instructionSet = (_instructionSet < bestInstructionSet) ? _instructionSet : bestInstructionSet;
+
+		if (instructionSet == INSTRUCTION_SET_AVX2)
+			return &evaluateAVX2;
+		if (instructionSet == INSTRUCTION_SET_SSE4)
+			return &evaluateSSE4;
+#else
+		(void)_instructionSet;
+#endif
+		return &evaluateScalar;
+	}
+
+	unsigned int NeighbourEvaluator::evaluateScalar(const int* _recordList, int _actualIndex, const int* _offsetList, int _actualG, unsigned int _moveMask, unsigned int _generation, int* _newGList)
+	{
+		unsigned int relaxMask = 0;
+
+		for (int direction = 0; direction < 8; ++direction)
+		{
+			_newGList[direction] = _actualG + COST_LIST[direction];
+			if ((_moveMask & (1 << direction)) == 0)
+				continue;
+
+			const int* record = _recordList + (_actualIndex + _offsetList[direction]) * RECORD_SIZE;
+			unsigned int stamp = (unsigned int)record[STAMP_OFFSET];
+			if (stamp == (_generation | NODE_CLOSED))
+				continue;
+			if (stamp == (_generation | NODE_OPEN) && _newGList[direction] >= record[G_OFFSET])
+				continue;
+
+			relaxMask |= 1 << direction;
+		}
+
+		return relaxMask;
+	}
+
+#ifdef PATHFINDER_SIMD
+	PATHFINDER_TARGET_SSE4
+	unsigned int NeighbourEvaluator::evaluateSSE4(const int* _recordList, int _actualIndex, const int* _offsetList, int _actualG, unsigned int _moveMask, unsigned int _generation, int* _newGList)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i moveMask = _mm_set1_epi32((int)_moveMask);
+		const __m128i closedStamp = _mm_set1_epi32((int)(_generation | NODE_CLOSED));
+		const __m128i openStamp = _mm_set1_epi32((int)(_generation | NODE_OPEN));
+		unsigned int relaxMask = 0;
+
+		for (int half = 0; half < 8; half += 4)
+		{
+			__m128i nodes = _mm_add_epi32(_mm_set1_epi32(_actualIndex), _mm_load_si128((const __m128i*)(_offsetList + half)));
+			__m128i records = _mm_mullo_epi32(nodes, _mm_set1_epi32(RECORD_SIZE));
+			__m128i bits = _mm_load_si128((const __m128i*)(BIT_LIST + half));
+			__m128i lanes = _mm_cmpeq_epi32(_mm_and_si128(moveMask, bits), bits);
+
+			// There is no gather before AVX2, the records of the allowed moves are read one by one
+			int laneMask = _mm_movemask_ps(_mm_castsi128_ps(lanes));
+			__m128i stamps = zero;
+			__m128i gs = zero;
+			if (laneMask & 1)
+			{
+				stamps = _mm_insert_epi32(stamps, _recordList[_mm_extract_epi32(records, 0) + STAMP_OFFSET], 0);
+				gs = _mm_insert_epi32(gs, _recordList[_mm_extract_epi32(records, 0) + G_OFFSET], 0);
+			}
+			if (laneMask & 2)
+			{
+				stamps = _mm_insert_epi32(stamps, _recordList[_mm_extract_epi32(records, 1) + STAMP_OFFSET], 1);
+				gs = _mm_insert_epi32(gs, _recordList[_mm_extract_epi32(records, 1) + G_OFFSET], 1);
+			}
+			if (laneMask & 4)
+			{
+				stamps = _mm_insert_epi32(stamps, _recordList[_mm_extract_epi32(records, 2) + STAMP_OFFSET], 2);
+				gs = _mm_insert_epi32(gs, _recordList[_mm_extract_epi32(records, 2) + G_OFFSET], 2);
+			}
+			if (laneMask & 8)
+			{
+				stamps = _mm_insert_epi32(stamps, _recordList[_mm_extract_epi32(records, 3) + STAMP_OFFSET], 3);
+				gs = _mm_insert_epi32(gs, _recordList[_mm_extract_epi32(records, 3) + G_OFFSET], 3);
+			}
+
+			__m128i newG = _mm_add_epi32(_mm_set1_epi32(_actualG), _mm_load_si128((const __m128i*)(COST_LIST + half)));
+			_mm_storeu_si128((__m128i*)(_newGList + half), newG);
+
+			// A neighbour is skipped when it is closed, or open with a G value not above the new one
+			__m128i isClosed = _mm_cmpeq_epi32(stamps, closedStamp);
+			__m128i isOpen = _mm_cmpeq_epi32(stamps, openStamp);
+			__m128i isImproved = _mm_cmpgt_epi32(gs, newG);
+			__m128i isSkipped = _mm_or_si128(isClosed, _mm_andnot_si128(isImproved, isOpen));
+			__m128i isRelaxed = _mm_andnot_si128(isSkipped, lanes);
+
+			relaxMask |= (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(isRelaxed)) << half;
+		}
+
+		return relaxMask;
+	}
+
+	PATHFINDER_TARGET_AVX2
+	unsigned int NeighbourEvaluator::evaluateAVX2(const int* _recordList, int _actualIndex, const int* _offsetList, int _actualG, unsigned int _moveMask, unsigned int _generation, int* _newGList)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+
+		__m256i nodes = _mm256_add_epi32(_mm256_set1_epi32(_actualIndex), _mm256_load_si256((const __m256i*)_offsetList));
+		// The index of the records is computed with two additions instead of a multiplication
+		static_assert(RECORD_SIZE == 3, "The AVX2 evaluation computes the index of the records for three integers per record");
+		__m256i records = _mm256_add_epi32(nodes, _mm256_add_epi32(nodes, nodes));
+		__m256i bits = _mm256_load_si256((const __m256i*)BIT_LIST);
+		__m256i lanes = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((int)_moveMask), bits), bits);
+
+		// The masked gathers do not read the records of the forbidden moves, which can be outside the map
+		__m256i stamps = _mm256_mask_i32gather_epi32(zero, _recordList + STAMP_OFFSET, records, lanes, 4);
+		__m256i gs = _mm256_mask_i32gather_epi32(zero, _recordList + G_OFFSET, records, lanes, 4);
+
+		__m256i newG = _mm256_add_epi32(_mm256_set1_epi32(_actualG), _mm256_load_si256((const __m256i*)COST_LIST));
+		_mm256_storeu_si256((__m256i*)_newGList, newG);
+
+		// A neighbour is skipped when it is closed, or open with a G value not above the new one
+		__m256i isClosed = _mm256_cmpeq_epi32(stamps, _mm256_set1_epi32((int)(_generation | NODE_CLOSED)));
+		__m256i isOpen = _mm256_cmpeq_epi32(stamps, _mm256_set1_epi32((int)(_generation | NODE_OPEN)));
+		__m256i isImproved = _mm256_cmpgt_epi32(gs, newG);
+		__m256i isSkipped = _mm256_or_si256(isClosed, _mm256_andnot_si256(isImproved, isOpen));
+		__m256i isRelaxed = _mm256_andnot_si256(isSkipped, lanes);
+
+		return (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(isRelaxed));
+	}
+#endif
+
+}
@@ -0,0 +1,89 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __NEIGHBOUR_EVALUATOR_H__
+#define __NEIGHBOUR_EVALUATOR_H__
+
+#include "PathFinderConfig.h"
+
+namespace fournier
+{
+	/// <summary>
+	/// Instructions used to evaluate the neighbours of a node.
+	/// </summary>
+	enum InstructionSet
+	{
+		/// <summary>
+		/// One neighbour after the other, on every processor.
+		/// </summary>
+		INSTRUCTION_SET_SCALAR,
+
+		/// <summary>
+		/// Four neighbours at a time with SSE4.1, the records are still read one by one.
+		/// </summary>
+		INSTRUCTION_SET_SSE4,
+
+		/// <summary>
+		/// The eight neighbours at once with AVX2, the records are read with two gathers.
+		/// </summary>
+		INSTRUCTION_SET_AVX2
+	};
+
+	/// <summary>
+	/// First stage of the expansion of a node by the A* search: find which of its 8 neighbours must be given to the open list.
+	/// The move mask of the node already holds the obstacles, the types and the heights (see TraversalProfile),
+	/// what is left is to skip the neighbours in the closed list and the ones in the open list with a G value already as small.
+	/// These checks only read the record of each neighbour, so they are done for the 8 neighbours together with the vector instructions.
+	///
+	/// The records are read as NodeRecord::SIZE integers per node, with the layout and the stamp flags of NodeRecord.
+	/// </summary>
+	class NeighbourEvaluator
+	{
+
+	public:
+
+		/// <summary>
+		/// Find the neighbours of a node to relax.
+		/// </summary>
+		/// <param name="_recordList">Records of every node of the map.</param>
+		/// <param name="_actualIndex">Index of the node being expanded.</param>
+		/// <param name="_offsetList">Difference between the index of the node and the ones of its neighbours, aligned on 32 bytes like the lists of NavigationGrid::getNeighbourOffsetList().</param>
+		/// <param name="_actualG">G value of the node.</param>
+		/// <param name="_moveMask">Directions in which a move is allowed, see TraversalProfile::getMoveMask(). No neighbour outside the map may be set.</param>
+		/// <param name="_generation">Generation of the search, the stamp of its open nodes is _generation | NodeRecord::STAMP_OPEN and the one of its closed nodes _generation | NodeRecord::STAMP_CLOSED.</param>
+		/// <param name="_newGList">Receive the G value of each neighbour reached from the node, at the index of its direction.</param>
+		/// <returns>Bit d set when the neighbour in the direction d must be relaxed with its new G value.</returns>
+		typedef unsigned int (*EvaluateFunction)(const int* _recordList, int _actualIndex, const int* _offsetList, int _actualG, unsigned int _moveMask, unsigned int _generation, int* _newGList);
+
+		/// <summary>
+		/// Best instruction set of the processor running the program, INSTRUCTION_SET_SCALAR if PATHFINDER_SIMD is not defined.
+		/// </summary>
+		static InstructionSet getBestInstructionSet();
+
+		/// <summary>
+		/// Get the function using an instruction set, or the best one of the processor if it does not have it.
+		/// </summary>
+		static EvaluateFunction getEvaluateFunction(InstructionSet _instructionSet);
+
+
+	private:
+
+		static unsigned int evaluateScalar(const int* _recordList, int _actualIndex, const int* _offsetList, int _actualG, unsigned int _moveMask, unsigned int _generation, int* _newGList);
+
+#ifdef PATHFINDER_SIMD
+		static unsigned int evaluateSSE4(const int* _recordList, int _actualIndex, const int* _offsetList, int _actualG, unsigned int _moveMask, unsigned int _generation, int* _newGList);
+
+		static unsigned int evaluateAVX2(const int* _recordList, int _actualIndex, const int* _offsetList, int _actualG, unsigned int _moveMask, unsigned int _generation, int* _newGList);
+#endif
+	};
+
+}
+
+#endif
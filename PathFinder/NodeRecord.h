@@ -0,0 +1,55 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __NODE_RECORD_H__
+#define __NODE_RECORD_H__
+
+#include <cstddef>
+
+namespace fournier
+{
+	/// <summary>
+	/// Data of a node for the actual A* search, everything is in 12 bytes so that a relaxation only reads one cache line.
+	/// The stamp holds the generation in which the node has been visited and the STAMP_OPEN or STAMP_CLOSED flag.
+	///
+	/// The NeighbourEvaluator reads the records as integers, with the layout given here.
+	/// </summary>
+	struct NodeRecord
+	{
+		int g;
+		int parent;
+		unsigned int stamp;
+
+		/// <summary>Flag of the stamp of a node in the open list.</summary>
+		static const unsigned int STAMP_OPEN = 1;
+
+		/// <summary>Flag of the stamp of a node in the closed list.</summary>
+		static const unsigned int STAMP_CLOSED = 2;
+
+		/// <summary>Difference between two generations of search, the bits below it hold the flags.</summary>
+		static const unsigned int GENERATION_STEP = 4;
+
+		/// <summary>Number of integers in a record.</summary>
+		static const int SIZE = 3;
+
+		/// <summary>Position of the G value in a record read as integers.</summary>
+		static const int G_OFFSET = 0;
+
+		/// <summary>Position of the stamp in a record read as integers.</summary>
+		static const int STAMP_OFFSET = 2;
+	};
+
+	static_assert(sizeof(NodeRecord) == NodeRecord::SIZE * sizeof(int), "The records are read as NodeRecord::SIZE integers");
+	static_assert(offsetof(NodeRecord, g) == NodeRecord::G_OFFSET * sizeof(int), "NodeRecord::G_OFFSET does not match the layout");
+	static_assert(offsetof(NodeRecord, stamp) == NodeRecord::STAMP_OFFSET * sizeof(int), "NodeRecord::STAMP_OFFSET does not match the layout");
+
+}
+
+#endif
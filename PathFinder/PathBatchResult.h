@@ -0,0 +1,59 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __PATH_BATCH_RESULT_H__
+#define __PATH_BATCH_RESULT_H__
+
+#include <vector>
+#include "WorldPosition.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// Path to one of the targets of a one-to-many search.
+	/// </summary>
+	struct TargetPathResult
+	{
+		/// <summary>Indicate if a path has been found to the target.</summary>
+		bool isPathFound = false;
+
+		/// <summary>Cost of the path, 256 for each straight move and 362 for each diagonal one. -1 if no path has been found.</summary>
+		int cost = -1;
+
+		/// <summary>Contains the list of all the points defining the path found, if the waypoints were asked for.</summary>
+		vector<WorldPosition> waypointsList;
+	};
+
+	/// <summary>
+	/// Hold the result of a PathFinder search from one position to many targets.
+	/// </summary>
+	struct PathBatchResult
+	{
+		/// <summary>Path to each target, in the order of the targets given to the search.</summary>
+		vector<TargetPathResult> targetResultList;
+
+		/// <summary>Total time in microseconds the PathFinder spent to find the paths.</summary>
+		long totalComputeTime = 0;
+
+		/// <summary>Time in microseconds the PathFinder spent on the search.</summary>
+		long AStarComputeTime = 0;
+
+		/// <summary>Time in microseconds the PathFinder spent on the creation of the waypoints.</summary>
+		long waypointsCreationTime = 0;
+
+		/// <summary>Number of node checked by the PathFinder to find the paths.</summary>
+		int numberNodeChecked = 0;
+	};
+
+}
+
+#endif
@@ -0,0 +1,137 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "PathCache.h"
+
+
+namespace fournier
+{
+	PathCache::PathCache()
+		: mMapVersion(0)
+	{
+	}
+
+	PathCache::~PathCache()
+	{
+		clear();
+	}
+
+	bool PathCache::findPath(const PathParam* _parameters, unsigned int _mapVersion, vector<WorldPosition>& _waypointsList)
+	{
+		setMapVersion(_mapVersion);
+
+		int startWaypoint, endWaypoint;
+		int n = findRoute(_parameters, startWaypoint, endWaypoint);
+		if (n == -1)
+			return false;
+
+		Route* route = mRouteList[n];
+		_waypointsList.assign(route->waypointsList.begin() + startWaypoint, route->waypointsList.begin() + endWaypoint + 1);
+
+		mRouteList.erase(mRouteList.begin() + n);
+		mRouteList.push_back(route);
+		return true;
+	}
+
+	void PathCache::addPath(const NavigationGrid& _grid, const PathParam* _parameters, unsigned int _mapVersion, const vector<WorldPosition>& _waypointsList)
+	{
+		setMapVersion(_mapVersion);
+
+		// A path given by the cache is already in it
+		int startWaypoint, endWaypoint;
+		if (_waypointsList.empty() || findRoute(_parameters, startWaypoint, endWaypoint) != -1)
+			return;
+
+		if ((int)mRouteList.size() >= MAXIMUM_ROUTES)
+		{
+			delete mRouteList.front();
+			mRouteList.erase(mRouteList.begin());
+		}
+
+		Route* route = new Route{ MoveRule(_parameters), _parameters->allowDiagonalMovements, _parameters->searchAlgorithm,
+			getOpenListEngine(_parameters), isUsingLandmarks(_parameters), _waypointsList, unordered_map<int, int>() };
+		for (int n = 0; n < (int)_waypointsList.size(); ++n)
+		{
+			int cellIndex = NavigationGrid::index(_waypointsList[n].x, _waypointsList[n].y);
+			if (_waypointsList[n].z == _grid.getHeight(cellIndex))
+				route->waypointOfCellList.emplace(cellIndex, n);
+		}
+
+		mRouteList.push_back(route);
+	}
+
+	void PathCache::clear()
+	{
+		for (auto it = mRouteList.begin(); it != mRouteList.end(); ++it)
+			delete (*it);
+		mRouteList.clear();
+	}
+
+	int PathCache::findRoute(const PathParam* _parameters, int& _startWaypoint, int& _endWaypoint) const
+	{
+		MoveRule moveRule(_parameters);
+		OpenListEngine openListEngine = getOpenListEngine(_parameters);
+		bool useLandmarkHeuristic = isUsingLandmarks(_parameters);
+		int startIndex = NavigationGrid::index(_parameters->startPosition.x, _parameters->startPosition.y);
+		int endIndex = NavigationGrid::index(_parameters->endPosition.x, _parameters->endPosition.y);
+
+		// The last used paths are the most likely to be asked again
+		for (int n = (int)mRouteList.size() - 1; n >= 0; --n)
+		{
+			const Route* route = mRouteList[n];
+			if (!(route->moveRule == moveRule) || route->allowDiagonalMovements != _parameters->allowDiagonalMovements || route->searchAlgorithm != _parameters->searchAlgorithm)
+				continue;
+			if (route->openListEngine != openListEngine || route->useLandmarkHeuristic != useLandmarkHeuristic)
+				continue;
+
+			auto start = route->waypointOfCellList.find(startIndex);
+			if (start == route->waypointOfCellList.end())
+				continue;
+
+			// The moves cannot always be made backward, the end must be after the start
+			auto end = route->waypointOfCellList.find(endIndex);
+			if (end == route->waypointOfCellList.end() || end->second < start->second)
+				continue;
+
+			_startWaypoint = start->second;
+			_endWaypoint = end->second;
+			return n;
+		}
+
+		return -1;
+	}
+
+	void PathCache::setMapVersion(unsigned int _mapVersion)
+	{
+		// A path found on an older version may cross a cell that is not walkable any more
+		if (_mapVersion != mMapVersion)
+		{
+			clear();
+			mMapVersion = _mapVersion;
+		}
+	}
+
+	OpenListEngine PathCache::getOpenListEngine(const PathParam* _parameters)
+	{
+		// Like PathFinder::acquireState(), the hierarchical searches keep the engine asked since their short queries are plain A* searches
+		if (isUsingLandmarks(_parameters) || _parameters->searchAlgorithm == SEARCH_BIDIRECTIONAL ||
+			(_parameters->searchAlgorithm == SEARCH_JUMP_POINT && _parameters->allowDiagonalMovements))
+			return OPEN_LIST_BINARY_HEAP;
+		return _parameters->openListEngine;
+	}
+
+	bool PathCache::isUsingLandmarks(const PathParam* _parameters)
+	{
+		if (_parameters->searchAlgorithm == SEARCH_BIDIRECTIONAL || (_parameters->searchAlgorithm == SEARCH_JUMP_POINT && _parameters->allowDiagonalMovements))
+			return false;
+		return _parameters->useLandmarkHeuristic;
+	}
+
+}
@@ -0,0 +1,124 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __PATH_CACHE_H__
+#define __PATH_CACHE_H__
+
+#include <vector>
+#include <unordered_map>
+#include "PathFinderConfig.h"
+#include "NavigationGrid.h"
+#include "MoveRule.h"
+#include "PathParam.h"
+#include "WorldPosition.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// Paths found by the last searches, given back to the searches asking for the same route or for a part of one.
+	/// A part of a path is a path too with the same parameters, and it is the shortest one when the path was.
+	/// The open list engine and the landmarks change the path found, so they are part of the parameters compared.
+	///
+	/// Each path is stored with the version of the map it was found on, and the paths of older versions are forgotten.
+	/// </summary>
+	class PathCache
+	{
+
+	private:
+
+		/// <summary>
+		/// A path and the parameters of the search that found it.
+		/// </summary>
+		struct Route
+		{
+			MoveRule moveRule;
+			bool allowDiagonalMovements;
+			SearchAlgorithm searchAlgorithm;
+			OpenListEngine openListEngine;
+			bool useLandmarkHeuristic;
+
+			vector<WorldPosition> waypointsList;
+
+			/// <summary>
+			/// Position in waypointsList of the waypoint of each cell of the path, at the height of the cell.
+			/// The other waypoints are the steps added between two cells of different heights.
+			/// </summary>
+			unordered_map<int, int> waypointOfCellList;
+		};
+
+		/// <summary>Number of paths kept.</summary>
+		static const int MAXIMUM_ROUTES = 64;
+
+		/// <summary>Paths found on the actual version of the map, the last used at the end.</summary>
+		vector<Route*> mRouteList;
+
+		/// <summary>Version of the map of the paths in mRouteList.</summary>
+		unsigned int mMapVersion;
+
+
+	public:
+
+		PathCache();
+
+		~PathCache();
+
+		/// <summary>
+		/// Find a path from the start to the end of a search in the paths kept.
+		/// </summary>
+		/// <param name="_mapVersion">Actual version of the map, the paths found on another one are forgotten.</param>
+		/// <param name="_waypointsList">Waypoints of the path, like the ones of a search.</param>
+		/// <returns>False if no path kept goes from the start to the end of the search.</returns>
+		bool findPath(const PathParam* _parameters, unsigned int _mapVersion, vector<WorldPosition>& _waypointsList);
+
+		/// <summary>
+		/// Keep the path found by a search.
+		/// </summary>
+		/// <param name="_mapVersion">Actual version of the map, the path must have been found on it.</param>
+		void addPath(const NavigationGrid& _grid, const PathParam* _parameters, unsigned int _mapVersion, const vector<WorldPosition>& _waypointsList);
+
+		/// <summary>
+		/// Forget every path.
+		/// </summary>
+		void clear();
+
+		inline int getNumberRoute() const { return mRouteList.size(); }
+
+
+	private:
+
+		/// <summary>
+		/// Find a path kept going from the start to the end of a search.
+		/// </summary>
+		/// <param name="_startWaypoint">Position of the waypoint of the start in the path found.</param>
+		/// <param name="_endWaypoint">Position of the waypoint of the end in the path found.</param>
+		/// <returns>Position of the path in mRouteList, -1 if none is found.</returns>
+		int findRoute(const PathParam* _parameters, int& _startWaypoint, int& _endWaypoint) const;
+
+		/// <summary>
+		/// Forget the paths found on another version of the map.
+		/// </summary>
+		void setMapVersion(unsigned int _mapVersion);
+
+		/// <summary>
+		/// Open list engine actually used by the search of the parameters, the searches that only run on the binary heap ignore the one asked.
+		/// </summary>
+		static OpenListEngine getOpenListEngine(const PathParam* _parameters);
+
+		/// <summary>
+		/// Indicate if the landmarks guide the search of the parameters, the Jump Point and bidirectional searches ignore them.
+		/// </summary>
+		static bool isUsingLandmarks(const PathParam* _parameters);
+	};
+
+}
+
+#endif
@@ -10,19 +10,20 @@
 
 #include "PathFinder.h"
 
-#include <array>
-#include <windows.h>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
 
-#include "../chunk.h"
-#include "../cube.h"
-#include "engine/timer.h"
+#include "GridSource.h"
+#include "NavigationSnapshot.h"
+#include "NYWorldGridSource.h"
 #include "WorldPosition.h"
 #include "PreciseTimer.h"
 
 
 inline int index(int _x, int _y)
 {
-	return _x + _y * MAT_SIZE_CUBES;
+	return fournier::NavigationGrid::index(_x, _y);
 }
 
 inline int manhatanDistance(int _x, int _y, int _destX, int _destY)
@@ -30,16 +31,35 @@ inline int manhatanDistance(int _x, int _y, int _destX, int _destY)
 	return ((_x < _destX) ? _destX - _x : _x - _destX) + ((_y < _destY) ? _destY - _y : _y - _destY);
 }
 
-inline void addNeightbours(int _x, int _y, array<int, 8> &_posX, array<int, 8> &_posY, int &_numberNeightbours)
+/// <summary>
+/// Cost of the shortest path between two cells on an open grid, with the diagonal moves if they are allowed.
+/// </summary>
+inline int octileDistance(int _x, int _y, int _destX, int _destY, bool _allowDiagonalMovements)
 {
-	if (_x < 0 || _x >= MAT_SIZE_CUBES || _y < 0 || _y >= MAT_SIZE_CUBES)
-		return;
+	int distanceX = (_x < _destX) ? _destX - _x : _x - _destX;
+	int distanceY = (_y < _destY) ? _destY - _y : _y - _destY;
+	int diagonal = _allowDiagonalMovements ? min(distanceX, distanceY) : 0;
+	return diagonal * fournier::MoveRule::COST_DIAGONAL + (distanceX + distanceY - 2 * diagonal) * fournier::MoveRule::COST_STRAIGHT;
+}
 
-	_posX[_numberNeightbours] = _x;
-	_posY[_numberNeightbours] = _y;
-	++_numberNeightbours;
+/// <summary>
+/// Heuristic of the A* search. The binary heap uses the Manhattan distance, which overestimates the diagonal moves and checks fewer nodes.
+/// The bucket queue needs a consistent heuristic so that its keys never go below the last one popped, it uses the octile distance.
+/// Without the diagonal moves both are the same.
+/// </summary>
+inline int aStarHeuristic(fournier::OpenListEngine _engine, bool _allowDiagonalMovements, int _x, int _y, int _destX, int _destY)
+{
+	if (_engine == fournier::OPEN_LIST_BUCKET_QUEUE)
+		return octileDistance(_x, _y, _destX, _destY, _allowDiagonalMovements);
+	return manhatanDistance(_x, _y, _destX, _destY) * fournier::MoveRule::COST_STRAIGHT;
 }
 
+/// <summary>
+/// Directions in which the A* search looks at the neighbours of a node, the straight moves first, see NavigationGrid::NEIGHBOUR_X.
+/// The order decides between the paths of same cost.
+/// </summary>
+static const int NEIGHBOUR_ORDER[8] = { 4, 0, 6, 2, 5, 1, 7, 3 };
+
 
 namespace fournier
 {
@@ -55,9 +75,26 @@ namespace fournier
 	PathFinder::PathFinder()
 	{
 		mIsInitialized = false;
-		mWorld = nullptr;
+		mGridSource = nullptr;
+		mOwnedGridSource = nullptr;
+		mSnapshot = nullptr;
 		mTimer = new PreciseTimer();
 		mTimeAllowedPerFrame = 5000;
+		mNumberWorkerThreads = 0;
+		mNumberInitializeThreads = 0;
+		mIsLazyLoading = false;
+		mMaximumNumberLoadedPages = 0;
+		mWorkerPool = nullptr;
+		mFrameNumber = 0;
+		mNumberLatencyRecorded = 0;
+		mMapVersion = 0;
+		setInstructionSet(NeighbourEvaluator::getBestInstructionSet());
+	}
+
+	void PathFinder::setInstructionSet(InstructionSet _instructionSet)
+	{
+		mInstructionSet = min(_instructionSet, NeighbourEvaluator::getBestInstructionSet());
+		mEvaluateNeighbours = NeighbourEvaluator::getEvaluateFunction(mInstructionSet);
 	}
 
 	PathFinder::~PathFinder()
@@ -79,61 +116,151 @@ namespace fournier
 		return mTimeAllowedPerFrame;
 	}
 
+#ifndef PATHFINDER_HEADLESS
 	void PathFinder::initialize(NYWorld* _world)
 	{
 		if (mIsInitialized)
 			return;
 
-		mWorld = _world;
+		mOwnedGridSource = new NYWorldGridSource(_world);
+		initialize(mOwnedGridSource);
+	}
+#endif
 
-		mHeightList = vector<int>(MAT_SIZE_CUBES * MAT_SIZE_CUBES);
-		mCubeTypeList = vector<NYCubeType>(MAT_SIZE_CUBES * MAT_SIZE_CUBES);
+	void PathFinder::initialize(GridSource* _gridSource)
+	{
+		if (mIsInitialized)
+			return;
 
-		for (unsigned int y = 0; y < MAT_SIZE_CUBES; ++y)
-		{
-			for (unsigned int x = 0; x < MAT_SIZE_CUBES; ++x)
-			{
-				for (unsigned int z = MAT_HEIGHT_CUBES; z >= 0; --z)
-				{
-					if (mWorld->getCube(x, y, z)->_Type == CUBE_AIR)
-						continue;
+		mGridSource = _gridSource;
+		mGrid.initialize(_gridSource->getSizeX(), _gridSource->getSizeY());
+		mPageLastUseList.assign(NavigationGrid::getNumberPage(), 0);
 
-					mHeightList[index(x, y)] = z;
-					mCubeTypeList[index(x, y)] = mWorld->getCube(x, y, z)->_Type;
-					mObstaclesList[index(x, y)] = false;
+		// With lazy loading the pages are read by the first searches reaching them
+		if (!mIsLazyLoading)
+			loadAllPages();
 
-					break;
-				}
-			}
+		mNumberSearchDone = 0;
+		mIsInitialized = true;
+	}
+
+	bool PathFinder::initialize(GridSource* _gridSource, const char* _snapshotPath, unsigned long long _worldVersion)
+	{
+		if (mIsInitialized)
+			return false;
+
+		mSnapshot = NavigationSnapshot::open(_snapshotPath, _worldVersion, _gridSource->getSizeX(), _gridSource->getSizeY());
+		if (mSnapshot == nullptr)
+		{
+			initialize(_gridSource);
+			return false;
 		}
 
+		// The profiles and components are up to date with the cells, they are ready for the first searches
+		mGridSource = _gridSource;
+		mGrid.attach(_gridSource->getSizeX(), _gridSource->getSizeY(), mSnapshot->getCellList());
+		mPageLastUseList.assign(NavigationGrid::getNumberPage(), 0);
+		mSnapshot->createTraversalProfiles(mTraversalProfileList);
+		mSnapshot->createComponentMaps(mComponentMapList);
+
 		mNumberSearchDone = 0;
 		mIsInitialized = true;
+		return true;
 	}
 
-	void PathFinder::reset()
+	bool PathFinder::saveSnapshot(const char* _path, unsigned long long _worldVersion, const vector<const PathParam*>& _parametersList)
 	{
-		mWorld = nullptr;
+		if (!mIsInitialized)
+			return false;
 
-		mHeightList.clear();
-		mCubeTypeList.clear();
+		loadAllPages();
 
-		for (auto it = mAStarStateList.begin(); it != mAStarStateList.end(); ++it)
+		for (auto it = _parametersList.begin(); it != _parametersList.end(); ++it)
 		{
-			delete (*it)->parameters;
-			delete (*it)->result;
+			getTraversalProfile(*it);
+			getComponentMap(*it);
 		}
-		mAStarStateList.clear();
 
-		mIsInitialized = false;
+		// The worker threads only read the map, it cannot change while it is written
+		return NavigationSnapshot::save(_path, _worldVersion, mGrid, mTraversalProfileList, mComponentMapList);
 	}
 
-	bool isInMapRange(int _x, int _y)
+	void PathFinder::initialize(const int* _heightList, const NYCubeType* _typeList)
 	{
-		if (_x < 0 || _x >= MAT_SIZE_CUBES ||
-			_y < 0 || _y >= MAT_SIZE_CUBES)
-			return false;
-		return true;
+		if (mIsInitialized)
+			return;
+
+		mGrid.initialize(MAT_SIZE_CUBES, MAT_SIZE_CUBES);
+		mGrid.setColumns(0, 0, MAT_SIZE_CUBES, MAT_SIZE_CUBES, _heightList, _typeList);
+		for (int pageY = 0; pageY < NavigationGrid::getNumberPageY(); ++pageY)
+			for (int pageX = 0; pageX < NavigationGrid::getNumberPageX(); ++pageX)
+				mGrid.setPageLoaded(NavigationGrid::getPage(pageX, pageY));
+		mPageLastUseList.assign(NavigationGrid::getNumberPage(), 0);
+
+		mNumberSearchDone = 0;
+		mIsInitialized = true;
+	}
+
+	void PathFinder::reset()
+	{
+		mGridSource = nullptr;
+
+		delete mOwnedGridSource;
+		mOwnedGridSource = nullptr;
+
+		// Cancel every search, the worker threads stop as soon as their actual slice is done
+		mGridLock.lockWrite();
+		dropAllSearches();
+		mGridLock.unlockWrite();
+
+		delete mWorkerPool;
+		mWorkerPool = nullptr;
+
+		collectFinishedStates();
+
+		mGrid.clear();
+		mPageLastUseList.clear();
+		mObstacleChangeList.clear();
+		mColumnChangeList.clear();
+		mPathCache.clear();
+
+		for (auto it = mJumpPointTableList.begin(); it != mJumpPointTableList.end(); ++it)
+			delete (*it);
+		mJumpPointTableList.clear();
+
+		for (auto it = mClusterGraphList.begin(); it != mClusterGraphList.end(); ++it)
+			delete (*it);
+		mClusterGraphList.clear();
+
+		for (auto it = mComponentMapList.begin(); it != mComponentMapList.end(); ++it)
+			delete (*it);
+		mComponentMapList.clear();
+
+		for (auto it = mTraversalProfileList.begin(); it != mTraversalProfileList.end(); ++it)
+			delete (*it);
+		mTraversalProfileList.clear();
+
+		for (auto it = mLandmarkTableList.begin(); it != mLandmarkTableList.end(); ++it)
+			delete (*it);
+		mLandmarkTableList.clear();
+
+		for (auto it = mReplanningSearchList.begin(); it != mReplanningSearchList.end(); ++it)
+			delete (*it);
+		mReplanningSearchList.clear();
+
+		for (auto it = mFlowFieldList.begin(); it != mFlowFieldList.end(); ++it)
+			delete (*it);
+		mFlowFieldList.clear();
+
+		for (auto it = mFreeAStarStateList.begin(); it != mFreeAStarStateList.end(); ++it)
+			delete (*it);
+		mFreeAStarStateList.clear();
+
+		// Nothing uses the memory of the snapshot any more
+		delete mSnapshot;
+		mSnapshot = nullptr;
+
+		mIsInitialized = false;
 	}
 
 	int PathFinder::getNumberSearchRunning() const
@@ -149,341 +276,1975 @@ namespace fournier
 		return idsList;
 	}
 
-	void PathFinder::setObstacle(const WorldPosition &_position, bool _hasObstacle)
+	ReplanningSearch* PathFinder::createReplanningSearch(const PathParam* _parameters)
 	{
-		if (!isInMapRange(_position.x, _position.y))
-			return;
-
-		// Check if the new state will change the map
-		bool lastState = mObstaclesList[index(_position.x, _position.y)];
-		if (lastState == _hasObstacle)
-			return;
+		if (!NavigationGrid::isInRange(_parameters->startPosition.x, _parameters->startPosition.y) || !NavigationGrid::isInRange(_parameters->endPosition.x, _parameters->endPosition.y))
+			return nullptr;
 
-		// Change the state
-		mObstaclesList[index(_position.x, _position.y)] = _hasObstacle;
+		loadAllPages();
 
-		// Stop and destroy every running search
-		for (auto it = mAStarStateList.begin(); it != mAStarStateList.end(); ++it)
-		{
-			delete (*it)->parameters;
-			delete (*it)->result;
-		}
-		mAStarStateList.clear();
+		ReplanningSearch* search = new ReplanningSearch(MoveRule(_parameters), _parameters->allowDiagonalMovements,
+			index(_parameters->startPosition.x, _parameters->startPosition.y), index(_parameters->endPosition.x, _parameters->endPosition.y));
+		mReplanningSearchList.push_back(search);
+		return search;
 	}
 
-	void PathFinder::update()
+	bool PathFinder::replan(ReplanningSearch* _search, const WorldPosition& _startPosition, PathResult* _result)
 	{
-		long maxAllowedTime = mTimeAllowedPerFrame;
-		long start, end;
-
-		/// Update all the A* search running
-		for (auto it = mAStarStateList.begin(); it != mAStarStateList.end();)
-		{
-			// We dont have any time left
-			if (maxAllowedTime <= 0)
-				break;
+		if (!NavigationGrid::isInRange(_startPosition.x, _startPosition.y))
+			return false;
 
-			(*it)->result->numbreFrame += 1;
+		long long startTimer = mTimer->getTimeMicroSeconds();
 
-			// A* search
-			if ((*it)->isAStarFinished == false)
-			{
-				start = mTimer->getTimeMicroSeconds();
-				int numberNodeChecked = 0;
+		// Only the main thread changes the map, so it can be read without the lock
+		_search->setStart(index(_startPosition.x, _startPosition.y));
+		int numberNodeChecked = _search->computeShortestPath(mGrid);
 
-				computeSearch(*it, numberNodeChecked, maxAllowedTime);
+		vector<int> cellList;
+		bool isPathFound = _search->getPath(mGrid, cellList);
 
-				end = mTimer->getTimeMicroSeconds();
+		long long middleTimer = mTimer->getTimeMicroSeconds();
 
-				maxAllowedTime -= end - start;
-				(*it)->result->numberNodeChecked += numberNodeChecked;
-				(*it)->result->AStarComputeTime += end - start;
-			}
+		// The waypoints are built from the list of cells in reverse order, like the ones of the other searches
+		vector<int> posX, posY;
+		for (auto it = cellList.rbegin(); it != cellList.rend(); ++it)
+		{
+			posX.push_back(NavigationGrid::getX(*it));
+			posY.push_back(NavigationGrid::getY(*it));
+		}
 
-			// We dont have any time left
-			if (maxAllowedTime <= 0)
-				break;
+		_result->waypointsList.clear();
+		if (isPathFound)
+			addWaypoints(posX, posY, _result->waypointsList);
 
-			// Construct the final list of waypoints
-			if ((*it)->isAStarFinished == true && (*it)->isPathGenerated == false)
-			{
-				start = mTimer->getTimeMicroSeconds();
+		long long endTimer = mTimer->getTimeMicroSeconds();
 
-				constructPath(*it);
+		_result->isPathFound = isPathFound;
+		_result->numberNodeChecked = numberNodeChecked;
+		_result->totalComputeTime = (long)(endTimer - startTimer);
+		_result->AStarComputeTime = (long)(middleTimer - startTimer);
+		_result->waypointsCreationTime = (long)(endTimer - middleTimer);
+		_result->numbreFrame = 0;
 
-				end = mTimer->getTimeMicroSeconds();
-				maxAllowedTime -= end - start;
-				(*it)->result->waypointsCreationTime += end - start;
-			}
+		return true;
+	}
 
-			// We dont have any time left
-			if (maxAllowedTime <= 0)
-				break;
+	void PathFinder::destroyReplanningSearch(ReplanningSearch* _search)
+	{
+		auto it = find(mReplanningSearchList.begin(), mReplanningSearchList.end(), _search);
+		if (it != mReplanningSearchList.end())
+			mReplanningSearchList.erase(it);
+		delete _search;
+	}
 
-			// Set the results and call the callback and remove the element
-			if ((*it)->isAStarFinished && (*it)->isPathGenerated)
-			{
-				if ((*it)->result->waypointsList.size() > 0 && 
-					(*it)->result->waypointsList.back().x == (*it)->parameters->endPosition.x && (*it)->result->waypointsList.back().y == (*it)->parameters->endPosition.y)
-					(*it)->result->isPathFound = true;
+	FlowField* PathFinder::createFlowField(const PathParam* _parameters)
+	{
+		if (!NavigationGrid::isInRange(_parameters->endPosition.x, _parameters->endPosition.y))
+			return nullptr;
 
-				(*it)->result->totalComputeTime += (*it)->result->AStarComputeTime + (*it)->result->waypointsCreationTime;
+		loadAllPages();
 
-				(*it)->callback((*it)->id, (*it)->parameters, (*it)->result);
-				it = mAStarStateList.erase(it);
-			}
-			else
-			{
-				++it;
-			}
-		}
+		FlowField* field = new FlowField(MoveRule(_parameters), _parameters->allowDiagonalMovements, index(_parameters->endPosition.x, _parameters->endPosition.y));
+		mFlowFieldList.push_back(field);
+		return field;
 	}
 
-	bool PathFinder::findPath(PathParam *_parameters, PathResult *_result)
+	bool PathFinder::getNextStep(FlowField* _field, const WorldPosition& _position, WorldPosition& _nextPosition)
 	{
-		// Create the state and save the parameters and results object
-		AStarState* state = new AStarState();
-		state->parameters = _parameters;
-		state->result = _result;
-		state->id = -1;
-		state->callback = nullptr;
-		state->isAStarFinished = false;
-		state->isPathGenerated = false;
-
-		mNumberSearchDone += 1;
+		if (!NavigationGrid::isInRange(_position.x, _position.y))
+			return false;
 
-		// Check if the two given positions are valids
-		if (!isInMapRange(state->parameters->startPosition.x, state->parameters->startPosition.y) || !isInMapRange(state->parameters->endPosition.x, state->parameters->endPosition.y))
+		// Only the main thread changes the map, so it can be read without the lock
+		int nextIndex;
+		if (!_field->getNextStep(mGrid, index(_position.x, _position.y), nextIndex))
 			return false;
 
-		// Make sure the result's datas are initialized
-		state->result->numbreFrame = 0;
-		state->result->numberNodeChecked = 0;
-		state->result->totalComputeTime = 0;
-		state->result->AStarComputeTime = 0;
-		state->result->waypointsCreationTime = 0;
+		_nextPosition = WorldPosition(NavigationGrid::getX(nextIndex), NavigationGrid::getY(nextIndex), mGrid.getHeight(nextIndex));
+		return true;
+	}
 
-		int numberNodeChecked = 0;
+	bool PathFinder::setFlowFieldGoal(FlowField* _field, const WorldPosition& _goalPosition)
+	{
+		if (!NavigationGrid::isInRange(_goalPosition.x, _goalPosition.y))
+			return false;
 
-		// Add the first node to the open list
-		state->addToOpenList(state->parameters->startPosition.x, state->parameters->startPosition.y);
+		_field->setGoal(index(_goalPosition.x, _goalPosition.y));
+		return true;
+	}
 
+	void PathFinder::destroyFlowField(FlowField* _field)
+	{
+		auto it = find(mFlowFieldList.begin(), mFlowFieldList.end(), _field);
+		if (it != mFlowFieldList.end())
+			mFlowFieldList.erase(it);
+		delete _field;
+	}
 
-		long startTimer = mTimer->getTimeMicroSeconds();
+	void PathFinder::setObstacle(const WorldPosition &_position, bool _hasObstacle)
+	{
+		queueObstacle(_position, _hasObstacle);
+		applyMapChanges();
+	}
 
-		// A* search
-		computeSearch(state, numberNodeChecked);
+	void PathFinder::queueObstacle(const WorldPosition &_position, bool _hasObstacle)
+	{
+		if (!NavigationGrid::isInRange(_position.x, _position.y))
+			return;
 
-		long middleTimer = mTimer->getTimeMicroSeconds();
+		mObstacleChangeList.push_back(make_pair(index(_position.x, _position.y), _hasObstacle));
+	}
 
-		// Construct the final list of waypoints
-		constructPath(state);
+	void PathFinder::setColumnsChanged(int _x, int _y, int _width, int _depth)
+	{
+		queueColumnsChanged(_x, _y, _width, _depth);
+		applyMapChanges();
+	}
 
-		long endTimer = mTimer->getTimeMicroSeconds();
+	void PathFinder::queueColumnsChanged(int _x, int _y, int _width, int _depth)
+	{
+		if (mGridSource == nullptr)
+			return;
 
+		ColumnChange change;
+		change.x = max(0, _x);
+		change.y = max(0, _y);
+		change.width = min(NavigationGrid::getSizeX(), _x + _width) - change.x;
+		change.depth = min(NavigationGrid::getSizeY(), _y + _depth) - change.y;
+		if (change.width > 0 && change.depth > 0)
+			mColumnChangeList.push_back(change);
+	}
 
-		// Save the final result
-		state->result->numberNodeChecked = numberNodeChecked;
-		state->result->totalComputeTime = endTimer - startTimer;
-		state->result->AStarComputeTime = middleTimer - startTimer;
-		state->result->waypointsCreationTime = endTimer - middleTimer;
-		
-		state->result->numbreFrame = 0;
+	void PathFinder::applyMapChanges()
+	{
+		if (mObstacleChangeList.empty() && mColumnChangeList.empty())
+			return;
 
-		if (state->result->waypointsList.back().x == state->parameters->endPosition.x && state->result->waypointsList.back().y == state->parameters->endPosition.y)
-			state->result->isPathFound = true;
+		// An obstacle is only kept by the grid, the page it is set on must be read before
+		if (mIsLazyLoading)
+		{
+			vector<int> pageList;
+			for (auto it = mObstacleChangeList.begin(); it != mObstacleChangeList.end(); ++it)
+				pageList.push_back(NavigationGrid::getPage((*it).first));
+			loadPages(pageList, false);
+		}
 
-		// Delete the state, but keep the parameters and result
-		delete state;
+		// The world is read before taking the lock, the worker threads go on searching meanwhile
+		vector<vector<int>> heightListList(mColumnChangeList.size());
+		vector<vector<NYCubeType>> typeListList(mColumnChangeList.size());
+		for (size_t n = 0; n < mColumnChangeList.size(); ++n)
+		{
+			const ColumnChange& change = mColumnChangeList[n];
+			heightListList[n].resize(change.width * change.depth);
+			typeListList[n].resize(change.width * change.depth);
+			mGridSource->readColumns(change.x, change.y, change.width, change.depth, heightListList[n].data(), typeListList[n].data());
+		}
 
-		return true;
-	}
+		// The worker threads must not read the map while it changes
+		mGridLock.lockWrite();
 
-	int PathFinder::startSearch(PathParam *_parameters, PathResult *_result, void(*_callback)(int, PathParam*, PathResult*))
-	{
-		// Create the state and save the parameters and results object
-		AStarState* state = new AStarState();
-		state->parameters = _parameters;
-		state->result = _result;
-		state->id = ++mNumberSearchDone;
-		state->callback = _callback;
-		state->isAStarFinished = false;
-		state->isPathGenerated = false;
+		vector<int> changedCellList;
+		bool isUnloadedPageChanged = false;
+		for (size_t n = 0; n < mColumnChangeList.size(); ++n)
+		{
+			const ColumnChange& change = mColumnChangeList[n];
 
-		// Check if the two given positions are valids
-		if (!isInMapRange(state->parameters->startPosition.x, state->parameters->startPosition.y) || !isInMapRange(state->parameters->endPosition.x, state->parameters->endPosition.y))
-			return -1;
+			// Most of the columns of a chunk keep their topmost cube, only the rectangle around the changed ones is given to the search data
+			int firstX = INT_MAX, firstY = INT_MAX, lastX = -1, lastY = -1;
+			for (int j = 0; j < change.depth; ++j)
+			{
+				for (int i = 0; i < change.width; ++i)
+				{
+					// The columns of a page not loaded are read with the page
+					int cellIndex = index(change.x + i, change.y + j);
+					if (!mGrid.isPageLoaded(NavigationGrid::getPage(cellIndex)))
+					{
+						isUnloadedPageChanged = true;
+						continue;
+					}
 
-		// Make sure the result's datas are initialized
-		state->result->numbreFrame = 0;
-		state->result->numberNodeChecked = 0;
-		state->result->totalComputeTime = 0;
-		state->result->AStarComputeTime = 0;
-		state->result->waypointsCreationTime = 0;
+					int height = heightListList[n][i + j * change.width];
+					NYCubeType type = typeListList[n][i + j * change.width];
+					if (mGrid.getHeight(cellIndex) == height && mGrid.getType(cellIndex) == type)
+						continue;
 
-		// Add the first node to the open list
-		state->addToOpenList(state->parameters->startPosition.x, state->parameters->startPosition.y);
+					mGrid.setColumns(change.x + i, change.y + j, 1, 1, &height, &type);
+					changedCellList.push_back(cellIndex);
+					firstX = min(firstX, change.x + i);
+					firstY = min(firstY, change.y + j);
+					lastX = max(lastX, change.x + i);
+					lastY = max(lastY, change.y + j);
+				}
+			}
 
-		// Save the state to be computed later
-		mAStarStateList.push_back(state);
+			if (lastX >= 0)
+				setCellsChanged(firstX, firstY, lastX - firstX + 1, lastY - firstY + 1);
+		}
+		mColumnChangeList.clear();
 
-		return state->id;
-	}
+		// The paths in the cache may cross the pages unloaded since they were found
+		if (isUnloadedPageChanged)
+			++mMapVersion;
 
-	void PathFinder::stopSearch(int _id)
-	{
-		// Find the corresponding AStarState
-		int index = -1;
-		for (int n = 0; n < (int)mAStarStateList.size(); ++n)
+		for (auto it = mObstacleChangeList.begin(); it != mObstacleChangeList.end(); ++it)
 		{
-			if (mAStarStateList[n]->id == _id)
-			{
-				index = n;
-				break;
-			}
+			// Check if the new state will change the map
+			if (mGrid.hasObstacle((*it).first) == (*it).second)
+				continue;
+
+			mGrid.setObstacle((*it).first, (*it).second);
+			setCellsChanged(NavigationGrid::getX((*it).first), NavigationGrid::getY((*it).first), 1, 1);
+			changedCellList.push_back((*it).first);
 		}
+		mObstacleChangeList.clear();
 
-		// Remove and delete the AStarState
-		if (index != -1)
-			mAStarStateList.erase(mAStarStateList.begin() + index);
-	}
+		if (!changedCellList.empty())
+			invalidateSearches(changedCellList);
 
+		mGridLock.unlockWrite();
+	}
 
-	bool PathFinder::computeSearch(AStarState* _state, int& _numberNodeChecked, long _maximumTimeAllowed)
+	void PathFinder::invalidateSearches(const vector<int>& _changedCellList)
 	{
-		// We used this to temporary store the position of each neightbours node
-		array<int, 8> neightboursXList, neightboursYList;
-		int numberValidNeightbours = 0;
-		long startTime = mTimer->getTimeMicroSeconds();
-
-		_state->isAStarFinished = false;
+		bool isSearchDataRefreshed = false;
 
-		while (!_state->isOpenListEmpty())
+		for (auto it = mAStarStateList.begin(); it != mAStarStateList.end(); ++it)
 		{
-			++_numberNodeChecked;
+			AStarState* state = *it;
 
-			// We check the time spent every after nodes
-			// The compute time to getTimerMicroseconds is insignifiant compared to the A* node's test
-			if (_maximumTimeAllowed > 0)
-				if (mTimer->getTimeMicroSeconds() - startTime >= _maximumTimeAllowed)
-					return false;
-
-
-			// Find the best node
-			int n = _state->getBestNodeInOpenList();
-			int actualX = n % MAT_SIZE_CUBES;
-			int actualY = n / MAT_SIZE_CUBES;
-			//_state->removeFromOpenList(actualX, actualY);
+			// A finished search keeps its path, it was valid when it was found
+			if (state->isPathGenerated || state->isCancelled)
+				continue;
 
-			// Check if we are at the destination
-			if (actualX == _state->parameters->endPosition.x && actualY == _state->parameters->endPosition.y)
+			// The jumps of these searches are already updated and their abstract graph is built again, they must use the new ones
+			// They only start again if a change is near the area they explored: a jump or the neighbours looked at from a jump point,
+			// a jump from a jump point already expanded, or a cluster whose graph was already used, the end cluster being linked when the search starts
+			if (state->jumpPointTable != nullptr || state->clusterGraph != nullptr)
 			{
-				_state->addToClosedList(actualX, actualY);
-				break;
-			}
+				if (!isSearchDataRefreshed)
+				{
+					refreshSearchData();
+					isSearchDataRefreshed = true;
+				}
 
-			// Find the valid neightbours of the actual node
-			numberValidNeightbours = 0;
+				bool isAffected = false;
+				for (auto cell = _changedCellList.begin(); cell != _changedCellList.end() && !isAffected; ++cell)
+				{
+					int x = NavigationGrid::getX(*cell);
+					int y = NavigationGrid::getY(*cell);
+					if (state->jumpPointTable != nullptr)
+					{
+						isAffected = state->isInExploredArea(x, y, 1);
+					}
+					else
+					{
+						int endX = state->parameters->endPosition.x;
+						int endY = state->parameters->endPosition.y;
+						isAffected = state->isInExploredArea(x, y, 2 * PATHFINDER_CLUSTER_SIZE) ||
+							(abs(x - endX) <= 2 * PATHFINDER_CLUSTER_SIZE && abs(y - endY) <= 2 * PATHFINDER_CLUSTER_SIZE);
+					}
+				}
 
-			addNeightbours(actualX - 1, actualY, neightboursXList, neightboursYList, numberValidNeightbours);
-			addNeightbours(actualX + 1, actualY, neightboursXList, neightboursYList, numberValidNeightbours);
-			addNeightbours(actualX, actualY - 1, neightboursXList, neightboursYList, numberValidNeightbours);
-			addNeightbours(actualX, actualY + 1, neightboursXList, neightboursYList, numberValidNeightbours);
+				// A jump skips the cells it walks on, a wall removed far along it changes where it stops without being near a jump point
+				if (!isAffected && state->jumpPointTable != nullptr)
+				{
+					const vector<int>& jumpChangedList = state->jumpPointTable->getChangedCellList();
+					for (auto cell = jumpChangedList.begin(); cell != jumpChangedList.end() && !isAffected; ++cell)
+						isAffected = state->isInClosedList(*cell);
+				}
 
-			if (_state->parameters->allowDiagonalMovements)
-			{
-				addNeightbours(actualX - 1, actualY - 1, neightboursXList, neightboursYList, numberValidNeightbours);
-				addNeightbours(actualX + 1, actualY + 1, neightboursXList, neightboursYList, numberValidNeightbours);
-				addNeightbours(actualX + 1, actualY - 1, neightboursXList, neightboursYList, numberValidNeightbours);
-				addNeightbours(actualX - 1, actualY + 1, neightboursXList, neightboursYList, numberValidNeightbours);
+				if (isAffected)
+					restartSearch(state);
+				continue;
 			}
 
-			// For each neightbours, check if it can be a valid waypoint for the path
-			for (int n = 0; n < numberValidNeightbours; ++n)
+			// The two searches of a bidirectional search are not repaired, they start again if a change is next to what they reached
+			if (state->reverseState != nullptr)
 			{
-				int newX = neightboursXList[n];
-				int newY = neightboursYList[n];
-
-				if (_state->isInClosedList(newX, newY))
-					continue;
-
-				// Check if there is an obstacle on the cube
-				if (mObstaclesList[index(newX, newY)])
-					continue;
-
-				// Check if the type of the cube is walkable
-				int numberWalkableCubeType = _state->parameters->walkableCubeTypeList.size();
-				if (numberWalkableCubeType > 0)
+				bool isAffected = false;
+				for (auto cell = _changedCellList.begin(); cell != _changedCellList.end() && !isAffected; ++cell)
 				{
-					NYCubeType type = mCubeTypeList[index(newX, newY)];
-					int canWalk = false;
-					for (auto it = _state->parameters->walkableCubeTypeList.begin(); it != _state->parameters->walkableCubeTypeList.end(); ++it)
+					int x = NavigationGrid::getX(*cell);
+					int y = NavigationGrid::getY(*cell);
+					for (int direction = -1; direction < 8 && !isAffected; ++direction)
 					{
-						if ((*it) == type)
-						{
-							canWalk = true;
-							break;
-						}
+						int neighbourX = (direction < 0) ? x : x + NavigationGrid::NEIGHBOUR_X[direction];
+						int neighbourY = (direction < 0) ? y : y + NavigationGrid::NEIGHBOUR_Y[direction];
+						if (!NavigationGrid::isInRange(neighbourX, neighbourY))
+							continue;
+
+						int neighbourIndex = index(neighbourX, neighbourY);
+						isAffected = state->isVisited(neighbourIndex) || state->reverseState->isVisited(neighbourIndex);
 					}
-					if (!canWalk)
-						continue;
 				}
-				
-				// The neightbour is too high
-				if (mHeightList[index(newX, newY)] - mHeightList[index(actualX, actualY)] > _state->parameters->maximumFallHeight)
-					continue;
-				
-				// The neightbour is too low
-				if (mHeightList[index(actualX, actualY)] - mHeightList[index(newX, newY)] > _state->parameters->maximumJumpHeight)
-					continue;
-				
-				bool isInOpenList = _state->isInOpenList(newX, newY);
 
-				// Update the neightbours node's data if needed
-				float newG = _state->G(actualX, actualY) + ((actualX != newX && actualY != newY) ? 1.4142f : 1.0f);
-				if (!isInOpenList || newG < _state->G(newX, newY))
-				{
-					_state->setParent(newX, newY, actualX, actualY);
-					_state->G(newX, newY, newG);
-					_state->H(newX, newY, (float)manhatanDistance(newX, newY, _state->parameters->endPosition.x, _state->parameters->endPosition.y));
-					_state->sortOpenList(newX, newY);
-				}
+				if (isAffected)
+					restartSearch(state);
+				continue;
+			}
 
-				// Add it the the open list
-				if (!isInOpenList)
-					_state->addToOpenList(newX, newY);
+			// A changed cell already reached can be on the path of any node after it
+			bool isAffected = false;
+			for (auto cell = _changedCellList.begin(); cell != _changedCellList.end() && !isAffected; ++cell)
+				isAffected = state->isVisited(*cell);
+
+			if (isAffected)
+			{
+				restartSearch(state);
+				continue;
 			}
 
-			// Add the actual node to the closed list
-			_state->addToClosedList(actualX, actualY);
+			// A changed cell next to the closed list may have become walkable, it is added to the open list like the closed node had seen it
+			if (state->isAStarFinished)
+				continue;
+
+			for (auto cell = _changedCellList.begin(); cell != _changedCellList.end(); ++cell)
+				repairSearch(state, *cell);
 		}
 
-		_state->isAStarFinished = true;
-		return true;
+		// The next changes only restart the searches that have expanded the cells they change
+		for (auto it = mJumpPointTableList.begin(); it != mJumpPointTableList.end(); ++it)
+			(*it)->clearChangedCells();
 	}
 
-	bool PathFinder::constructPath(AStarState *_state, long _maximumTimeAllowed)
+	void PathFinder::restartSearch(AStarState* _state)
 	{
-		vector<int> posX, posY;
-		int x, y, z, nextX, nextY, nextZ;
+		const PathParam* parameters = _state->parameters;
 
-		_state->isPathGenerated = false;
+		// The worker thread running the search keeps it, and computes it again from its start with its next slice
+		bool isDispatched = _state->isDispatched;
 
-		// Get the list of every point in the path
-		_state->getListPoint(posX, posY);
+		_state->reset(_state->getOpenListEngine());
+		_state->isDispatched = isDispatched;
+		_state->mapVersion = mMapVersion;
+		_state->addStartNode(index(parameters->startPosition.x, parameters->startPosition.y), aStarHeuristic(_state->getOpenListEngine(), parameters->allowDiagonalMovements,
+			parameters->startPosition.x, parameters->startPosition.y, parameters->endPosition.x, parameters->endPosition.y));
 
-		if (posX.size() > 0)
+		if (_state->reverseState != nullptr)
 		{
-			nextX = posX[posX.size() - 1];
-			nextY = posY[posY.size() - 1];
-			nextZ = mHeightList[index(nextX, nextY)];
+			_state->reverseState->reset(OPEN_LIST_BINARY_HEAP);
+			_state->reverseState->addStartNode(index(_state->parameters->endPosition.x, _state->parameters->endPosition.y), 0);
 		}
+	}
 
-		for (int n = (int)posX.size() - 1; n >= 0; --n)
+	void PathFinder::repairSearch(AStarState* _state, int _cellIndex)
+	{
+		const PathParam* parameters = _state->parameters;
+		MoveRule moveRule(parameters);
+		int x = NavigationGrid::getX(_cellIndex);
+		int y = NavigationGrid::getY(_cellIndex);
+		int directionStep = parameters->allowDiagonalMovements ? 1 : 2;
+
+		// Find the closed neighbour that gives the smallest G value
+		int bestParent = -1;
+		int bestG = INT_MAX;
+		for (int direction = 0; direction < 8; direction += directionStep)
 		{
-			long startTime = mTimer->getTimeMicroSeconds();
+			int neighbourX = x + NavigationGrid::NEIGHBOUR_X[direction];
+			int neighbourY = y + NavigationGrid::NEIGHBOUR_Y[direction];
+			if (!NavigationGrid::isInRange(neighbourX, neighbourY))
+				continue;
 
-			// We check the time spent every after nodes
+			int neighbourIndex = index(neighbourX, neighbourY);
+			if (!_state->isInClosedList(neighbourIndex) || !moveRule.canMove(mGrid, neighbourIndex, _cellIndex))
+				continue;
+
+			int g = _state->G(neighbourIndex) + ((direction & 1) ? COST_DIAGONAL : COST_STRAIGHT);
+			if (g < bestG)
+			{
+				bestG = g;
+				bestParent = neighbourIndex;
+			}
+		}
+
+		if (bestParent == -1)
+			return;
+
+		int h = aStarHeuristic(_state->getOpenListEngine(), parameters->allowDiagonalMovements, x, y, parameters->endPosition.x, parameters->endPosition.y);
+		if (_state->landmarkTable != nullptr)
+			h = max(h, _state->landmarkTable->getLowerBound(_cellIndex, index(parameters->endPosition.x, parameters->endPosition.y)));
+		_state->relaxNode(_cellIndex, bestParent, bestG, h);
+	}
+
+	void PathFinder::refreshSearchData()
+	{
+		for (auto it = mJumpPointTableList.begin(); it != mJumpPointTableList.end(); ++it)
+			if ((*it)->isDirty())
+				(*it)->build(mGrid);
+
+		for (auto it = mClusterGraphList.begin(); it != mClusterGraphList.end(); ++it)
+			if ((*it)->isDirty())
+				(*it)->update(mGrid);
+	}
+
+	void PathFinder::setNumberInitializeThreads(int _numberThread)
+	{
+		mNumberInitializeThreads = max(0, _numberThread);
+	}
+
+	void PathFinder::setLazyLoading(bool _isLazyLoading)
+	{
+		// The map is read at once or page by page from the start
+		if (mIsInitialized)
+			return;
+
+		mIsLazyLoading = _isLazyLoading;
+	}
+
+	void PathFinder::setMaximumNumberLoadedPages(int _numberPage)
+	{
+		mMaximumNumberLoadedPages = max(0, _numberPage);
+	}
+
+	void PathFinder::setNumberWorkerThreads(int _numberThread)
+	{
+		if (_numberThread < 0)
+			_numberThread = 0;
+
+		if (_numberThread == mNumberWorkerThreads)
+			return;
+
+		mNumberWorkerThreads = _numberThread;
+
+		// The actual threads finish the searches they already have before being stopped
+		delete mWorkerPool;
+		mWorkerPool = nullptr;
+
+		if (mNumberWorkerThreads == 0)
+			return;
+
+		// The searches waiting for update() are given to the new threads
+		mWorkerPool = new ThreadPool(mNumberWorkerThreads);
+		for (auto it = mAStarStateList.begin(); it != mAStarStateList.end(); ++it)
+		{
+			if (!(*it)->isDispatched)
+				dispatchState(*it);
+		}
+	}
+
+	int PathFinder::getNumberWorkerThreads() const
+	{
+		return mNumberWorkerThreads;
+	}
+
+	long PathFinder::getSearchLatencyPercentile(float _percentile) const
+	{
+		if (mLatencyList.empty())
+			return 0;
+
+		vector<long> sortedLatencyList = mLatencyList;
+		sort(sortedLatencyList.begin(), sortedLatencyList.end());
+
+		int position = (int)(_percentile / 100.0f * (sortedLatencyList.size() - 1) + 0.5f);
+		position = max(0, min(position, (int)sortedLatencyList.size() - 1));
+		return sortedLatencyList[position];
+	}
+
+	void PathFinder::clearSearchLatencies()
+	{
+		mLatencyList.clear();
+		mNumberLatencyRecorded = 0;
+	}
+
+	void PathFinder::update()
+	{
+		// The obstacles and columns changed during the last frame are applied together
+		applyMapChanges();
+
+		mFrameNumber += 1;
+
+		// Hand the searches finished by the worker threads back to the user
+		collectFinishedStates();
+
+		// The memory no longer used is given back before the searches take some more
+		releaseColdStates();
+		unloadPages();
+
+		// The worker threads do all the computations
+		if (mWorkerPool != nullptr)
+		{
+			for (auto it = mAStarStateList.begin(); it != mAStarStateList.end(); ++it)
+				(*it)->result->numbreFrame += 1;
+			return;
+		}
+
+		long maxAllowedTime = mTimeAllowedPerFrame;
+		long long start, end;
+
+		// Order the searches: the earliest deadline first, then the highest priority, then the short queries,
+		// and finally the ones that waited the longest so that the long searches share the time in a round-robin way
+		vector<AStarState*> scheduledStateList = mAStarStateList;
+		stable_sort(scheduledStateList.begin(), scheduledStateList.end(), [](const AStarState* _a, const AStarState* _b)
+		{
+			if (_a->deadlineTime != _b->deadlineTime)
+				return _a->deadlineTime < _b->deadlineTime;
+			if (_a->parameters->priority != _b->parameters->priority)
+				return _a->parameters->priority > _b->parameters->priority;
+			if (_a->isShortQuery != _b->isShortQuery)
+				return _a->isShortQuery;
+			return _a->lastFrameComputed < _b->lastFrameComputed;
+		});
+
+		/// Update all the A* search running
+		for (int n = 0; n < (int)scheduledStateList.size(); ++n)
+		{
+			AStarState* state = scheduledStateList[n];
+
+			// We dont have any time left
+			if (maxAllowedTime <= 0)
+				break;
+
+			state->result->numbreFrame += 1;
+			state->lastFrameComputed = mFrameNumber;
+
+			// The urgent searches can use all the time left, the others share it with the searches after them
+			long sliceTime = maxAllowedTime;
+			if (state->deadlineTime == LLONG_MAX && !state->isShortQuery)
+			{
+				long minimumSliceTime = MINIMUM_SLICE_TIME;
+				sliceTime = max(maxAllowedTime / (long)(scheduledStateList.size() - n), min(maxAllowedTime, minimumSliceTime));
+			}
+
+			// A* search
+			if (state->isAStarFinished == false)
+			{
+				start = mTimer->getTimeMicroSeconds();
+				int numberNodeChecked = 0;
+
+				// A search stopped on a page not loaded goes on with the rest of its time once the page is read
+				long remainingTime = sliceTime;
+				while (!computeSearch(state, numberNodeChecked, remainingTime) && state->missingPage != -1)
+				{
+					loadMissingPage(state);
+					remainingTime = sliceTime - (long)(mTimer->getTimeMicroSeconds() - start);
+					if (remainingTime <= 0)
+						break;
+				}
+
+				end = mTimer->getTimeMicroSeconds();
+
+				maxAllowedTime -= (long)(end - start);
+				state->result->numberNodeChecked += numberNodeChecked;
+				state->result->AStarComputeTime += (long)(end - start);
+			}
+
+			// We dont have any time left
+			if (maxAllowedTime <= 0)
+				break;
+
+			// Construct the final list of waypoints
+			if (state->isAStarFinished == true && state->isPathGenerated == false)
+			{
+				start = mTimer->getTimeMicroSeconds();
+
+				constructPath(state);
+
+				end = mTimer->getTimeMicroSeconds();
+				maxAllowedTime -= (long)(end - start);
+				state->result->waypointsCreationTime += (long)(end - start);
+			}
+
+			// Remove the element before calling the callback, it may start new searches
+			if (state->isAStarFinished && state->isPathGenerated)
+			{
+				mAStarStateList.erase(find(mAStarStateList.begin(), mAStarStateList.end(), state));
+				finishSearch(state);
+			}
+		}
+	}
+
+	void PathFinder::finishSearch(AStarState* _state)
+	{
+		// Set the results and call the callback
+		if (_state->result->waypointsList.size() > 0 &&
+			_state->result->waypointsList.back().x == _state->parameters->endPosition.x && _state->result->waypointsList.back().y == _state->parameters->endPosition.y)
+			_state->result->isPathFound = true;
+
+		// A search that went on while the map changed far from it may have a path that is not valid any more
+		if (_state->result->isPathFound && _state->mapVersion == mMapVersion)
+			mPathCache.addPath(mGrid, _state->parameters, mMapVersion, _state->result->waypointsList);
+
+		_state->result->totalComputeTime += _state->result->AStarComputeTime + _state->result->waypointsCreationTime;
+
+		// Keep the latency of the last searches to compute the percentiles
+		long long now = mTimer->getTimeMicroSeconds();
+		_state->result->latency = (long)(now - _state->startTime);
+		_state->result->isDeadlineMissed = (now > _state->deadlineTime);
+
+		if ((int)mLatencyList.size() < LATENCY_WINDOW)
+			mLatencyList.push_back(_state->result->latency);
+		else
+			mLatencyList[mNumberLatencyRecorded % LATENCY_WINDOW] = _state->result->latency;
+		mNumberLatencyRecorded += 1;
+
+		_state->callback(_state->id, _state->parameters, _state->result);
+		releaseState(_state);
+	}
+
+	void PathFinder::dropAllSearches()
+	{
+		for (auto it = mAStarStateList.begin(); it != mAStarStateList.end(); ++it)
+		{
+			// A state given to a worker thread is released once the thread gives it back
+			if ((*it)->isDispatched)
+				(*it)->isCancelled = true;
+			else
+				releaseState(*it);
+		}
+		mAStarStateList.clear();
+	}
+
+	void PathFinder::dispatchState(AStarState* _state)
+	{
+		_state->isDispatched = true;
+		mWorkerPool->addTask([this, _state]() { runSearchOnWorker(_state); });
+	}
+
+	void PathFinder::runSearchOnWorker(AStarState* _state)
+	{
+		bool isDone = false;
+
+		while (!isDone)
+		{
+			// The map can only change between two slices
+			mGridLock.lockRead();
+
+			if (_state->isCancelled)
+			{
+				mGridLock.unlockRead();
+				break;
+			}
+
+			if (_state->isAStarFinished == false)
+			{
+				long long start = mTimer->getTimeMicroSeconds();
+				int numberNodeChecked = 0;
+
+				computeSearch(_state, numberNodeChecked, WORKER_SLICE_TIME);
+
+				_state->result->numberNodeChecked += numberNodeChecked;
+				_state->result->AStarComputeTime += (long)(mTimer->getTimeMicroSeconds() - start);
+			}
+
+			if (_state->isAStarFinished == true && _state->isPathGenerated == false)
+			{
+				long long start = mTimer->getTimeMicroSeconds();
+
+				constructPath(_state);
+
+				_state->result->waypointsCreationTime += (long)(mTimer->getTimeMicroSeconds() - start);
+			}
+
+			// The pages are loaded by the main thread, the search is given back to it to read the page it has stopped on
+			isDone = _state->isPathGenerated || _state->missingPage != -1;
+
+			mGridLock.unlockRead();
+		}
+
+		lock_guard<mutex> lock(mFinishedStateMutex);
+		mFinishedStateList.push_back(_state);
+	}
+
+	void PathFinder::collectFinishedStates()
+	{
+		vector<AStarState*> finishedStateList;
+		{
+			lock_guard<mutex> lock(mFinishedStateMutex);
+			finishedStateList.swap(mFinishedStateList);
+		}
+
+		for (auto it = finishedStateList.begin(); it != finishedStateList.end(); ++it)
+		{
+			// Stopped or dropped while running, the parameters and result are no longer ours
+			if ((*it)->isCancelled)
+			{
+				releaseState(*it);
+				continue;
+			}
+
+			// Waiting for a page, it goes back to the threads once it is read or to update() if there are no threads any more
+			if ((*it)->missingPage != -1)
+			{
+				loadMissingPage(*it);
+				(*it)->isDispatched = false;
+				if (mWorkerPool != nullptr)
+					dispatchState(*it);
+				continue;
+			}
+
+			mAStarStateList.erase(remove(mAStarStateList.begin(), mAStarStateList.end(), *it), mAStarStateList.end());
+			finishSearch(*it);
+		}
+	}
+
+	bool PathFinder::findPath(PathParam *_parameters, PathResult *_result)
+	{
+		mNumberSearchDone += 1;
+
+		// Check if the two given positions are valids
+		if (!NavigationGrid::isInRange(_parameters->startPosition.x, _parameters->startPosition.y) || !NavigationGrid::isInRange(_parameters->endPosition.x, _parameters->endPosition.y))
+			return false;
+
+		// The same route or a longer one going through both positions has already been found
+		long long cacheTimer = mTimer->getTimeMicroSeconds();
+		if (mPathCache.findPath(_parameters, mMapVersion, _result->waypointsList))
+		{
+			_result->isPathFound = true;
+			_result->numbreFrame = 0;
+			_result->numberNodeChecked = 0;
+			_result->AStarComputeTime = 0;
+			_result->waypointsCreationTime = (long)(mTimer->getTimeMicroSeconds() - cacheTimer);
+			_result->totalComputeTime = _result->waypointsCreationTime;
+			return true;
+		}
+
+		// Get a state and save the parameters and results object
+		AStarState* state = acquireState(_parameters, _result);
+		state->id = -1;
+		state->callback = nullptr;
+
+		int numberNodeChecked = 0;
+
+		// Add the first node to the open list
+		state->addStartNode(index(_parameters->startPosition.x, _parameters->startPosition.y), aStarHeuristic(state->getOpenListEngine(), _parameters->allowDiagonalMovements,
+			_parameters->startPosition.x, _parameters->startPosition.y, _parameters->endPosition.x, _parameters->endPosition.y));
+
+
+		long long startTimer = mTimer->getTimeMicroSeconds();
+
+		// A* search, not needed when the end is in another component than the start
+		if (canReach(_parameters))
+		{
+			while (!computeSearch(state, numberNodeChecked) && state->missingPage != -1)
+				loadMissingPage(state);
+		}
+		else
+			state->isAStarFinished = true;
+
+		long long middleTimer = mTimer->getTimeMicroSeconds();
+
+		// Construct the final list of waypoints
+		constructPath(state);
+
+		long long endTimer = mTimer->getTimeMicroSeconds();
+
+
+		// Save the final result
+		state->result->numberNodeChecked = numberNodeChecked;
+		state->result->totalComputeTime = (long)(endTimer - startTimer);
+		state->result->AStarComputeTime = (long)(middleTimer - startTimer);
+		state->result->waypointsCreationTime = (long)(endTimer - middleTimer);
+		
+		state->result->numbreFrame = 0;
+
+		if (state->result->waypointsList.size() > 0 &&
+			state->result->waypointsList.back().x == state->parameters->endPosition.x && state->result->waypointsList.back().y == state->parameters->endPosition.y)
+			state->result->isPathFound = true;
+
+		if (state->result->isPathFound)
+			mPathCache.addPath(mGrid, _parameters, mMapVersion, state->result->waypointsList);
+
+		// Give back the state, but keep the parameters and result
+		releaseState(state);
+
+		return true;
+	}
+
+	bool PathFinder::findPaths(PathParam *_parameters, const vector<WorldPosition>& _targetList, PathBatchResult *_result, bool _isWaypointsWanted)
+	{
+		mNumberSearchDone += 1;
+
+		if (!NavigationGrid::isInRange(_parameters->startPosition.x, _parameters->startPosition.y))
+			return false;
+
+		// The targets can be anywhere, the search does not check the pages it reaches
+		loadAllPages();
+
+		long long startTimer = mTimer->getTimeMicroSeconds();
+
+		// Plain Dijkstra search, every neighbour read in the masks of the profile
+		// A heuristic toward the closest target would have to be computed for each target at each node, for fewer nodes saved than it costs
+		AStarState* state = takeFreeState();
+		state->reset(_parameters->openListEngine);
+		state->traversalProfile = getTraversalProfile(_parameters);
+		state->jumpPointTable = nullptr;
+		state->clusterGraph = nullptr;
+		state->parameters = _parameters;
+		state->result = nullptr;
+
+		int startIndex = index(_parameters->startPosition.x, _parameters->startPosition.y);
+
+		// The search goes on until every target that can be reached is in the closed list
+		// The targets in another component than the start are not waited for, the search would have to explore the whole component
+		// With lazy loading there are no components, like in canReach()
+		ComponentMap* componentMap = mIsLazyLoading ? nullptr : getComponentMap(_parameters);
+		vector<int> remainingTargetList;
+		for (auto it = _targetList.begin(); it != _targetList.end(); ++it)
+		{
+			if (!NavigationGrid::isInRange(it->x, it->y))
+				continue;
+
+			int targetIndex = index(it->x, it->y);
+			if (componentMap == nullptr || componentMap->canReach(mGrid, startIndex, targetIndex))
+				remainingTargetList.push_back(targetIndex);
+		}
+		sort(remainingTargetList.begin(), remainingTargetList.end());
+		remainingTargetList.erase(unique(remainingTargetList.begin(), remainingTargetList.end()), remainingTargetList.end());
+
+		state->addStartNode(startIndex, 0);
+
+		const int* neighbourX = NavigationGrid::NEIGHBOUR_X;
+		const int* neighbourY = NavigationGrid::NEIGHBOUR_Y;
+		int directionMask = _parameters->allowDiagonalMovements ? TraversalProfile::ALL_MOVES : TraversalProfile::STRAIGHT_MOVES;
+		int numberRemainingTarget = remainingTargetList.size();
+		int numberNodeChecked = 0;
+
+		while (numberRemainingTarget > 0 && !state->isOpenListEmpty())
+		{
+			++numberNodeChecked;
+
+			int actualIndex = state->getBestNodeInOpenList();
+			state->addToClosedList(actualIndex);
+
+			if (binary_search(remainingTargetList.begin(), remainingTargetList.end(), actualIndex))
+				--numberRemainingTarget;
+
+			int actualX = NavigationGrid::getX(actualIndex);
+			int actualY = NavigationGrid::getY(actualIndex);
+			int moveMask = state->traversalProfile->getMoveMask(actualIndex) & directionMask;
+			int actualG = state->G(actualIndex);
+
+			for (int direction = 0; direction < 8; ++direction)
+			{
+				if ((moveMask & (1 << direction)) == 0)
+					continue;
+
+				int newIndex = index(actualX + neighbourX[direction], actualY + neighbourY[direction]);
+				if (state->isInClosedList(newIndex))
+					continue;
+
+				int newG = actualG + ((direction & 1) ? COST_DIAGONAL : COST_STRAIGHT);
+				if (!state->isInOpenList(newIndex) || newG < state->node(newIndex).g)
+					state->relaxNode(newIndex, actualIndex, newG, 0);
+			}
+		}
+
+		long long middleTimer = mTimer->getTimeMicroSeconds();
+
+		// The path to each target follows the parents of the nodes, from the target to the start
+		_result->targetResultList.assign(_targetList.size(), TargetPathResult());
+		for (int n = 0; n < (int)_targetList.size(); ++n)
+		{
+			if (!NavigationGrid::isInRange(_targetList[n].x, _targetList[n].y))
+				continue;
+
+			int targetIndex = index(_targetList[n].x, _targetList[n].y);
+			if (!state->isInClosedList(targetIndex))
+				continue;
+
+			TargetPathResult& targetResult = _result->targetResultList[n];
+			targetResult.isPathFound = true;
+			targetResult.cost = state->G(targetIndex);
+
+			if (_isWaypointsWanted)
+			{
+				vector<int> posX, posY;
+				for (int cell = targetIndex; cell != -1; cell = state->getParent(cell))
+				{
+					posX.push_back(NavigationGrid::getX(cell));
+					posY.push_back(NavigationGrid::getY(cell));
+				}
+				addWaypoints(posX, posY, targetResult.waypointsList);
+			}
+		}
+
+		long long endTimer = mTimer->getTimeMicroSeconds();
+
+		_result->numberNodeChecked = numberNodeChecked;
+		_result->totalComputeTime = (long)(endTimer - startTimer);
+		_result->AStarComputeTime = (long)(middleTimer - startTimer);
+		_result->waypointsCreationTime = (long)(endTimer - middleTimer);
+
+		releaseState(state);
+
+		return true;
+	}
+
+	int PathFinder::startSearch(PathParam *_parameters, PathResult *_result, void(*_callback)(int, PathParam*, PathResult*))
+	{
+		int id = ++mNumberSearchDone;
+
+		// Check if the two given positions are valids
+		if (!NavigationGrid::isInRange(_parameters->startPosition.x, _parameters->startPosition.y) || !NavigationGrid::isInRange(_parameters->endPosition.x, _parameters->endPosition.y))
+			return -1;
+
+		// The path is already known, or the end is in another component than the start, like in findPath()
+		// The search is finished without computing anything: its state only carries the result to the callback, called by the next update()
+		AStarState* state;
+		if (mPathCache.findPath(_parameters, mMapVersion, _result->waypointsList))
+		{
+			state = acquireFinishedState(_parameters, _result);
+		}
+		else if (!canReach(_parameters))
+		{
+			_result->waypointsList.clear();
+			state = acquireFinishedState(_parameters, _result);
+		}
+		else
+		{
+			// Get a state and save the parameters and results object
+			state = acquireState(_parameters, _result);
+
+			// Add the first node to the open list
+			state->addStartNode(index(_parameters->startPosition.x, _parameters->startPosition.y), aStarHeuristic(state->getOpenListEngine(), _parameters->allowDiagonalMovements,
+				_parameters->startPosition.x, _parameters->startPosition.y, _parameters->endPosition.x, _parameters->endPosition.y));
+		}
+		state->id = id;
+		state->callback = _callback;
+
+		// Data used to schedule the search in update()
+		state->startTime = mTimer->getTimeMicroSeconds();
+		state->deadlineTime = (_parameters->deadline >= 0) ? state->startTime + _parameters->deadline : LLONG_MAX;
+		state->isShortQuery = manhatanDistance(_parameters->startPosition.x, _parameters->startPosition.y, _parameters->endPosition.x, _parameters->endPosition.y) <= SHORT_QUERY_DISTANCE;
+		state->lastFrameComputed = mFrameNumber;
+
+		// Save the state to be computed later, by update() or by a worker thread
+		mAStarStateList.push_back(state);
+
+		if (mNumberWorkerThreads > 0)
+		{
+			if (mWorkerPool == nullptr)
+				mWorkerPool = new ThreadPool(mNumberWorkerThreads);
+			dispatchState(state);
+		}
+
+		return state->id;
+	}
+
+	void PathFinder::stopSearch(int _id)
+	{
+		// Find the corresponding AStarState
+		int index = -1;
+		for (int n = 0; n < (int)mAStarStateList.size(); ++n)
+		{
+			if (mAStarStateList[n]->id == _id)
+			{
+				index = n;
+				break;
+			}
+		}
+
+		// Remove the AStarState and give it back to the pool, or let the worker thread running it give it back
+		if (index != -1)
+		{
+			if (mAStarStateList[index]->isDispatched)
+				mAStarStateList[index]->isCancelled = true;
+			else
+				releaseState(mAStarStateList[index]);
+			mAStarStateList.erase(mAStarStateList.begin() + index);
+		}
+	}
+
+	PathFinder::AStarState* PathFinder::takeFreeState()
+	{
+		if (mFreeAStarStateList.empty())
+			return new AStarState();
+
+		AStarState* state = mFreeAStarStateList.back();
+		mFreeAStarStateList.pop_back();
+		return state;
+	}
+
+	PathFinder::AStarState* PathFinder::acquireState(PathParam* _parameters, PathResult* _result)
+	{
+		AStarState* state = takeFreeState();
+
+		// A short path crosses few clusters and the entrances would make it longer, the normal search is used for it
+		int distance = manhatanDistance(_parameters->startPosition.x, _parameters->startPosition.y, _parameters->endPosition.x, _parameters->endPosition.y);
+		bool isHierarchicalSearch = (_parameters->searchAlgorithm == SEARCH_HIERARCHICAL && distance > SHORT_QUERY_DISTANCE);
+
+		// A jump or an abstract edge moves the F value further than the spread of the bucket queue, so these searches always use the heap
+		// The bidirectional search needs the smallest F value of both open lists to know when to stop, so it uses the heap too,
+		// like the searches with landmarks whose costs are not refreshed yet after a change of the map
+		bool isJumpPointSearch = (_parameters->searchAlgorithm == SEARCH_JUMP_POINT && _parameters->allowDiagonalMovements);
+		bool isBidirectionalSearch = (_parameters->searchAlgorithm == SEARCH_BIDIRECTIONAL);
+		bool isLandmarkSearch = (_parameters->useLandmarkHeuristic && !isJumpPointSearch && !isHierarchicalSearch && !isBidirectionalSearch);
+
+		// Only the A* search reads the pages when it reaches them, the other ones and their data use the whole map
+		if (isJumpPointSearch || isHierarchicalSearch || isBidirectionalSearch || isLandmarkSearch)
+			loadAllPages();
+
+		state->reset((isJumpPointSearch || isHierarchicalSearch || isBidirectionalSearch || isLandmarkSearch) ? OPEN_LIST_BINARY_HEAP : _parameters->openListEngine);
+		state->traversalProfile = (!isJumpPointSearch && !isHierarchicalSearch) ? getTraversalProfile(_parameters) : nullptr;
+		state->landmarkTable = isLandmarkSearch ? getLandmarkTable(_parameters) : nullptr;
+		state->jumpPointTable = isJumpPointSearch ? getJumpPointTable(_parameters) : nullptr;
+		state->clusterGraph = isHierarchicalSearch ? getClusterGraph(_parameters) : nullptr;
+		state->parameters = _parameters;
+		state->result = _result;
+		state->mapVersion = mMapVersion;
+
+		// The search from the end uses a state of the pool too, it is released with the main one
+		if (isBidirectionalSearch)
+		{
+			state->reverseState = takeFreeState();
+			state->reverseState->reset(OPEN_LIST_BINARY_HEAP);
+			state->reverseState->addStartNode(index(_parameters->endPosition.x, _parameters->endPosition.y), 0);
+		}
+
+		// Make sure the result's datas are initialized
+		state->result->isPathFound = false;
+		state->result->numbreFrame = 0;
+		state->result->numberNodeChecked = 0;
+		state->result->totalComputeTime = 0;
+		state->result->AStarComputeTime = 0;
+		state->result->waypointsCreationTime = 0;
+
+		return state;
+	}
+
+	PathFinder::AStarState* PathFinder::acquireFinishedState(PathParam* _parameters, PathResult* _result)
+	{
+		// The open list already allocated is kept, nothing is read or built for the search
+		AStarState* state = takeFreeState();
+		state->reset(state->getOpenListEngine());
+		state->traversalProfile = nullptr;
+		state->landmarkTable = nullptr;
+		state->jumpPointTable = nullptr;
+		state->clusterGraph = nullptr;
+		state->parameters = _parameters;
+		state->result = _result;
+		state->mapVersion = mMapVersion;
+		state->isAStarFinished = true;
+		state->isPathGenerated = true;
+
+		state->result->isPathFound = false;
+		state->result->numbreFrame = 0;
+		state->result->numberNodeChecked = 0;
+		state->result->totalComputeTime = 0;
+		state->result->AStarComputeTime = 0;
+		state->result->waypointsCreationTime = 0;
+
+		return state;
+	}
+
+	void PathFinder::releaseState(AStarState* _state)
+	{
+		if (_state->reverseState != nullptr)
+		{
+			releaseState(_state->reverseState);
+			_state->reverseState = nullptr;
+		}
+
+		// The pages of the path found are the ones the next searches will most likely need
+		if (mIsLazyLoading)
+			setPagesUsed(_state);
+
+		_state->parameters = nullptr;
+		_state->result = nullptr;
+		_state->callback = nullptr;
+
+		if ((int)mFreeAStarStateList.size() >= MAXIMUM_FREE_STATES)
+		{
+			delete _state;
+			return;
+		}
+
+		_state->releaseFrame = mFrameNumber;
+		mFreeAStarStateList.push_back(_state);
+	}
+
+
+	bool PathFinder::computeSearch(AStarState* _state, int& _numberNodeChecked, long _maximumTimeAllowed)
+	{
+		// The jumps of the Jump Point Search use the diagonal moves, without them it would only find straight lines
+		if (_state->parameters->searchAlgorithm == SEARCH_JUMP_POINT && _state->parameters->allowDiagonalMovements)
+			return computeJumpPointSearch(_state, _numberNodeChecked, _maximumTimeAllowed);
+		if (_state->clusterGraph != nullptr)
+			return computeHierarchicalSearch(_state, _numberNodeChecked, _maximumTimeAllowed);
+		if (_state->reverseState != nullptr)
+			return computeBidirectionalSearch(_state, _numberNodeChecked, _maximumTimeAllowed);
+		return computeAStarSearch(_state, _numberNodeChecked, _maximumTimeAllowed);
+	}
+
+	bool PathFinder::computeAStarSearch(AStarState* _state, int& _numberNodeChecked, long _maximumTimeAllowed)
+	{
+		// One kernel is compiled for each combination, at the index engine * 8 + diagonal * 4 + landmarks * 2 + budgeted
+		typedef bool (PathFinder::*AStarKernel)(AStarState*, int&, long);
+		static const AStarKernel KERNEL_LIST[16] =
+		{
+			&PathFinder::computeAStarKernel<OPEN_LIST_BINARY_HEAP, false, false, false>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BINARY_HEAP, false, false, true>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BINARY_HEAP, false, true, false>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BINARY_HEAP, false, true, true>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BINARY_HEAP, true, false, false>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BINARY_HEAP, true, false, true>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BINARY_HEAP, true, true, false>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BINARY_HEAP, true, true, true>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BUCKET_QUEUE, false, false, false>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BUCKET_QUEUE, false, false, true>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BUCKET_QUEUE, false, true, false>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BUCKET_QUEUE, false, true, true>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BUCKET_QUEUE, true, false, false>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BUCKET_QUEUE, true, false, true>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BUCKET_QUEUE, true, true, false>,
+			&PathFinder::computeAStarKernel<OPEN_LIST_BUCKET_QUEUE, true, true, true>
+		};
+
+		int kernelIndex = ((_state->getOpenListEngine() == OPEN_LIST_BUCKET_QUEUE) ? 8 : 0) +
+			(_state->parameters->allowDiagonalMovements ? 4 : 0) +
+			((_state->landmarkTable != nullptr) ? 2 : 0) +
+			((_maximumTimeAllowed > 0) ? 1 : 0);
+
+		return (this->*KERNEL_LIST[kernelIndex])(_state, _numberNodeChecked, _maximumTimeAllowed);
+	}
+
+	template<OpenListEngine ENGINE, bool ALLOW_DIAGONAL, bool USE_LANDMARKS, bool IS_BUDGETED>
+	bool PathFinder::computeAStarKernel(AStarState* _state, int& _numberNodeChecked, long _maximumTimeAllowed)
+	{
+		const int* neighbourX = NavigationGrid::NEIGHBOUR_X;
+		const int* neighbourY = NavigationGrid::NEIGHBOUR_Y;
+		long long startTime = IS_BUDGETED ? mTimer->getTimeMicroSeconds() : 0;
+
+		const PathParam* parameters = _state->parameters;
+		const TraversalProfile* traversalProfile = _state->traversalProfile;
+		const LandmarkTable* landmarkTable = _state->landmarkTable;
+		int endX = parameters->endPosition.x;
+		int endY = parameters->endPosition.y;
+		int endIndex = index(endX, endY);
+
+		// The straight moves are the first ones of NEIGHBOUR_ORDER, a search without the diagonal moves stops before the others
+		const int numberDirections = ALLOW_DIAGONAL ? 8 : 4;
+		const unsigned int directionMask = ALLOW_DIAGONAL ? TraversalProfile::ALL_MOVES : TraversalProfile::STRAIGHT_MOVES;
+		NeighbourEvaluator::EvaluateFunction evaluateNeighbours = mEvaluateNeighbours;
+		int newGList[8];
+
+		_state->isAStarFinished = false;
+
+		while (!_state->template isOpenListEmpty<ENGINE>())
+		{
+			++_numberNodeChecked;
+
+			// We check the time spent every after nodes
+			// The compute time to getTimerMicroseconds is insignifiant compared to the A* node's test
+			if (IS_BUDGETED)
+				if (mTimer->getTimeMicroSeconds() - startTime >= _maximumTimeAllowed)
+					return false;
+
+
+			// Find the best node
+			int actualIndex = _state->template getBestNodeInOpenList<ENGINE>();
+			int actualX = NavigationGrid::getX(actualIndex);
+			int actualY = NavigationGrid::getY(actualIndex);
+
+			// The moves of a node are only known once its page and the pages around it are read
+			// The node goes back to the open list and the caller loads the page before going on, see loadMissingPage()
+			int actualPage = NavigationGrid::getPage(actualIndex);
+			if (!mGrid.isPageReady(actualPage))
+			{
+				int h = aStarHeuristic(ENGINE, ALLOW_DIAGONAL, actualX, actualY, endX, endY);
+				if (USE_LANDMARKS)
+					h = max(h, landmarkTable->getLowerBound(actualIndex, endIndex));
+				_state->template returnToOpenList<ENGINE>(actualIndex, h);
+				_state->missingPage = actualPage;
+				--_numberNodeChecked;
+				return false;
+			}
+			_state->addToExploredArea(actualX, actualY);
+
+			// Check if we are at the destination
+			if (actualIndex == endIndex)
+			{
+				_state->addToClosedList(actualIndex);
+				break;
+			}
+
+			// The obstacles, the types and the heights of the neighbours are already checked in the mask of the node,
+			// the closed list and the G values of the open list are checked for the 8 neighbours at once
+			unsigned int moveMask = traversalProfile->getMoveMask(actualIndex) & directionMask;
+			const int* offsetList = NavigationGrid::getNeighbourOffsetList(actualIndex);
+			unsigned int relaxMask = evaluateNeighbours(_state->getRecordList(), actualIndex, offsetList, _state->G(actualIndex), moveMask, _state->getGeneration(), newGList);
+
+			for (int n = 0; n < numberDirections && relaxMask != 0; ++n)
+			{
+				int direction = NEIGHBOUR_ORDER[n];
+				if ((relaxMask & (1 << direction)) == 0)
+					continue;
+				relaxMask &= ~(1 << direction);
+
+				int newX = actualX + neighbourX[direction];
+				int newY = actualY + neighbourY[direction];
+				int newIndex = actualIndex + offsetList[direction];
+				int newG = newGList[direction];
+
+				// The landmarks know the detours around the obstacles, the distance on an open grid keeps the search as direct as without them
+				int h = aStarHeuristic(ENGINE, ALLOW_DIAGONAL, newX, newY, endX, endY);
+				if (USE_LANDMARKS)
+					h = max(h, landmarkTable->getLowerBound(newIndex, endIndex));
+				_state->template relaxNode<ENGINE>(newIndex, actualIndex, newG, h);
+			}
+
+			// Add the actual node to the closed list
+			_state->addToClosedList(actualIndex);
+		}
+
+		_state->isAStarFinished = true;
+		return true;
+	}
+
+	bool PathFinder::computeBidirectionalSearch(AStarState* _state, int& _numberNodeChecked, long _maximumTimeAllowed)
+	{
+		const int* neighbourX = NavigationGrid::NEIGHBOUR_X;
+		const int* neighbourY = NavigationGrid::NEIGHBOUR_Y;
+		long long startTime = mTimer->getTimeMicroSeconds();
+
+		const PathParam* parameters = _state->parameters;
+		const TraversalProfile* traversalProfile = _state->traversalProfile;
+		AStarState* reverseState = _state->reverseState;
+		int startX = parameters->startPosition.x;
+		int startY = parameters->startPosition.y;
+		int endX = parameters->endPosition.x;
+		int endY = parameters->endPosition.y;
+		bool allowDiagonalMovements = parameters->allowDiagonalMovements;
+		int directionMask = allowDiagonalMovements ? TraversalProfile::ALL_MOVES : TraversalProfile::STRAIGHT_MOVES;
+
+		_state->isAStarFinished = false;
+
+		if (_state->meetingNode == -1 && startX == endX && startY == endY)
+		{
+			_state->meetingNode = index(startX, startY);
+			_state->bestPathCost = 0;
+		}
+
+		// The heuristics are consistent, so no path through a node still in one of the open lists
+		// can be shorter than the smallest F value of that list: the search stops when it reaches the best path found
+		while (!_state->isOpenListEmpty() && !reverseState->isOpenListEmpty() &&
+			max(_state->getBestKeyInOpenList(), reverseState->getBestKeyInOpenList()) < _state->bestPathCost)
+		{
+			++_numberNodeChecked;
+
+			if (_maximumTimeAllowed > 0)
+				if (mTimer->getTimeMicroSeconds() - startTime >= _maximumTimeAllowed)
+					return false;
+
+			// Expand the side with the fewest open nodes, it is the one growing the slowest
+			bool isForward = (_state->getOpenListSize() <= reverseState->getOpenListSize());
+			AStarState* searchState = isForward ? _state : reverseState;
+			AStarState* otherState = isForward ? reverseState : _state;
+			int targetX = isForward ? endX : startX;
+			int targetY = isForward ? endY : startY;
+
+			int actualIndex = searchState->getBestNodeInOpenList();
+			int actualX = NavigationGrid::getX(actualIndex);
+			int actualY = NavigationGrid::getY(actualIndex);
+			int actualG = searchState->G(actualIndex);
+			int moveMask = isForward ? (traversalProfile->getMoveMask(actualIndex) & directionMask) : directionMask;
+
+			for (int n = 0; n < 8; ++n)
+			{
+				int direction = NEIGHBOUR_ORDER[n];
+				if ((moveMask & (1 << direction)) == 0)
+					continue;
+
+				int newX = actualX + neighbourX[direction];
+				int newY = actualY + neighbourY[direction];
+				if (!isForward && !NavigationGrid::isInRange(newX, newY))
+					continue;
+
+				int newIndex = index(newX, newY);
+
+				// The search from the end walks the moves backward: the move from the neighbour to the node must be possible,
+				// the jump and fall heights are not the same both ways
+				if (!isForward && (traversalProfile->getMoveMask(newIndex) & (1 << ((direction + 4) & 7))) == 0)
+					continue;
+
+				if (searchState->isInClosedList(newIndex))
+					continue;
+
+				int newG = actualG + ((direction & 1) ? COST_DIAGONAL : COST_STRAIGHT);
+				if (searchState->isInOpenList(newIndex) && newG >= searchState->node(newIndex).g)
+					continue;
+
+				searchState->relaxNode(newIndex, actualIndex, newG, octileDistance(newX, newY, targetX, targetY, allowDiagonalMovements));
+
+				// The two searches meet, keep the shortest path going through both of them
+				if (otherState->isVisited(newIndex) && newG + otherState->G(newIndex) < _state->bestPathCost)
+				{
+					_state->bestPathCost = newG + otherState->G(newIndex);
+					_state->meetingNode = newIndex;
+				}
+			}
+
+			searchState->addToClosedList(actualIndex);
+		}
+
+		_state->isAStarFinished = true;
+		return true;
+	}
+
+	bool PathFinder::computeJumpPointSearch(AStarState* _state, int& _numberNodeChecked, long _maximumTimeAllowed)
+	{
+		const int* neighbourX = NavigationGrid::NEIGHBOUR_X;
+		const int* neighbourY = NavigationGrid::NEIGHBOUR_Y;
+		const JumpPointTable* jumpPointTable = _state->jumpPointTable;
+		long long startTime = mTimer->getTimeMicroSeconds();
+
+		int endX = _state->parameters->endPosition.x;
+		int endY = _state->parameters->endPosition.y;
+
+		_state->isAStarFinished = false;
+
+		while (!_state->isOpenListEmpty())
+		{
+			++_numberNodeChecked;
+
+			if (_maximumTimeAllowed > 0)
+				if (mTimer->getTimeMicroSeconds() - startTime >= _maximumTimeAllowed)
+					return false;
+
+			int actualIndex = _state->getBestNodeInOpenList();
+			int actualX = NavigationGrid::getX(actualIndex);
+			int actualY = NavigationGrid::getY(actualIndex);
+
+			if (actualX == endX && actualY == endY)
+			{
+				_state->addToClosedList(actualIndex);
+				break;
+			}
+
+			// The direction of the move from the parent gives the neighbours to look at, the start node and the irregular cells look in every direction
+			int parentIndex = _state->getParent(actualIndex);
+			int direction = -1;
+			if (parentIndex != -1 && !jumpPointTable->isIrregular(actualIndex))
+			{
+				int moveX = actualX - NavigationGrid::getX(parentIndex);
+				int moveY = actualY - NavigationGrid::getY(parentIndex);
+				moveX = (moveX > 0) - (moveX < 0);
+				moveY = (moveY > 0) - (moveY < 0);
+
+				for (direction = 0; neighbourX[direction] != moveX || neighbourY[direction] != moveY; ++direction);
+			}
+
+			int actualG = _state->G(actualIndex);
+
+			for (int n = 0; n < 8; ++n)
+			{
+				if (direction != -1 && !jumpPointTable->isNeighbourKept(mGrid, actualX, actualY, direction, n))
+					continue;
+
+				int numberStep = jumpPointTable->jump(actualX, actualY, n, endX, endY);
+				if (numberStep == 0)
+					continue;
+
+				int jumpX = actualX + numberStep * neighbourX[n];
+				int jumpY = actualY + numberStep * neighbourY[n];
+				int jumpIndex = index(jumpX, jumpY);
+				if (_state->isInClosedList(jumpIndex))
+					continue;
+
+				// Every cell between the actual node and the jump point is walked in the same direction
+				int newG = actualG + numberStep * ((n & 1) ? COST_DIAGONAL : COST_STRAIGHT);
+				if (!_state->isInOpenList(jumpIndex) || newG < _state->node(jumpIndex).g)
+				{
+					_state->relaxNode(jumpIndex, actualIndex, newG, manhatanDistance(jumpX, jumpY, endX, endY) * COST_STRAIGHT);
+					_state->addToExploredArea(jumpIndex);
+				}
+			}
+
+			_state->addToClosedList(actualIndex);
+		}
+
+		_state->isAStarFinished = true;
+		return true;
+	}
+
+	bool PathFinder::computeHierarchicalSearch(AStarState* _state, int& _numberNodeChecked, long _maximumTimeAllowed)
+	{
+		const ClusterGraph* clusterGraph = _state->clusterGraph;
+		long long startTime = mTimer->getTimeMicroSeconds();
+
+		int startIndex = index(_state->parameters->startPosition.x, _state->parameters->startPosition.y);
+		int endX = _state->parameters->endPosition.x;
+		int endY = _state->parameters->endPosition.y;
+		int endIndex = index(endX, endY);
+		int startCluster = ClusterGraph::getCluster(startIndex);
+		int endCluster = ClusterGraph::getCluster(endIndex);
+
+		_state->isAStarFinished = false;
+
+		// Link the start and end cells to the nodes of their clusters, they are not nodes of the graph
+		if (!_state->isConnected)
+		{
+			_numberNodeChecked += clusterGraph->computeNodeCosts(mGrid, startCluster, startIndex, false, _state->startCostList);
+			_numberNodeChecked += clusterGraph->computeNodeCosts(mGrid, endCluster, endIndex, true, _state->endCostList);
+			_state->directCost = (startCluster == endCluster) ? clusterGraph->computeCost(mGrid, startCluster, startIndex, endIndex) : -1;
+			_state->isConnected = true;
+		}
+
+		// Search in the abstract graph, the nodes are the cells of the entrances
+		while (_state->abstractPathList.empty() && !_state->isOpenListEmpty())
+		{
+			++_numberNodeChecked;
+
+			if (_maximumTimeAllowed > 0)
+				if (mTimer->getTimeMicroSeconds() - startTime >= _maximumTimeAllowed)
+					return false;
+
+			int actualIndex = _state->getBestNodeInOpenList();
+			if (actualIndex == endIndex)
+			{
+				_state->addToClosedList(actualIndex);
+
+				for (int node = endIndex; node != -1; node = _state->getParent(node))
+					_state->abstractPathList.push_back(node);
+				reverse(_state->abstractPathList.begin(), _state->abstractPathList.end());
+				_state->refinedPathList.push_back(startIndex);
+				break;
+			}
+
+			int actualCluster = ClusterGraph::getCluster(actualIndex);
+			const ClusterGraph::Cluster& cluster = clusterGraph->cluster(actualCluster);
+			int actualNode = clusterGraph->findNode(actualCluster, actualIndex);
+			int numberNode = cluster.nodeCellList.size();
+			int actualG = _state->G(actualIndex);
+
+			// Edges to the nodes of the same cluster, and to the end cell
+			const int* costList = nullptr;
+			int endCost = -1;
+			if (actualIndex == startIndex)
+			{
+				costList = _state->startCostList.data();
+				endCost = _state->directCost;
+			}
+			else if (actualNode != -1)
+			{
+				costList = &cluster.costList[actualNode * numberNode];
+				if (actualCluster == endCluster)
+					endCost = _state->endCostList[actualNode];
+			}
+
+			for (int n = 0; costList != nullptr && n < numberNode; ++n)
+			{
+				int nodeIndex = cluster.nodeCellList[n];
+				if (costList[n] <= 0 || _state->isInClosedList(nodeIndex))
+					continue;
+
+				int newG = actualG + costList[n];
+				if (!_state->isInOpenList(nodeIndex) || newG < _state->node(nodeIndex).g)
+				{
+					_state->relaxNode(nodeIndex, actualIndex, newG, manhatanDistance(NavigationGrid::getX(nodeIndex), NavigationGrid::getY(nodeIndex), endX, endY) * COST_STRAIGHT);
+					_state->addToExploredArea(nodeIndex);
+				}
+			}
+
+			if (endCost != -1 && !_state->isInClosedList(endIndex))
+			{
+				int newG = actualG + endCost;
+				if (!_state->isInOpenList(endIndex) || newG < _state->node(endIndex).g)
+				{
+					_state->relaxNode(endIndex, actualIndex, newG, 0);
+					_state->addToExploredArea(endIndex);
+				}
+			}
+
+			// Edges to the nodes of the neighbour clusters
+			for (auto it = cluster.transitionList.begin(); it != cluster.transitionList.end(); ++it)
+			{
+				if ((*it).fromCell != actualIndex || _state->isInClosedList((*it).toCell))
+					continue;
+
+				int nodeIndex = (*it).toCell;
+				int newG = actualG + (*it).cost;
+				if (!_state->isInOpenList(nodeIndex) || newG < _state->node(nodeIndex).g)
+				{
+					_state->relaxNode(nodeIndex, actualIndex, newG, manhatanDistance(NavigationGrid::getX(nodeIndex), NavigationGrid::getY(nodeIndex), endX, endY) * COST_STRAIGHT);
+					_state->addToExploredArea(nodeIndex);
+				}
+			}
+
+			_state->addToClosedList(actualIndex);
+		}
+
+		// Refine the edges of the abstract path into cells, a transition is a single move
+		while (_state->numberRefinedEdge + 1 < (int)_state->abstractPathList.size())
+		{
+			if (_maximumTimeAllowed > 0)
+				if (mTimer->getTimeMicroSeconds() - startTime >= _maximumTimeAllowed)
+					return false;
+
+			int fromIndex = _state->abstractPathList[_state->numberRefinedEdge];
+			int toIndex = _state->abstractPathList[_state->numberRefinedEdge + 1];
+			int cluster = ClusterGraph::getCluster(fromIndex);
+
+			if (cluster == ClusterGraph::getCluster(toIndex))
+				_numberNodeChecked += clusterGraph->findPath(mGrid, cluster, fromIndex, toIndex, _state->refinedPathList);
+			else
+				_state->refinedPathList.push_back(toIndex);
+
+			++_state->numberRefinedEdge;
+		}
+
+		_state->isAStarFinished = true;
+		return true;
+	}
+
+	/// <summary>
+	/// Find the data built for the searches matching a rule in a list kept in the order of use, and put it at the end.
+	/// When it is not found a new one is created, after forgetting the least recently used one not needed by a running search if the list is full.
+	/// </summary>
+	template<typename SearchData, typename MatchFunction, typename UsedFunction, typename CreateFunction>
+	SearchData* findSearchData(vector<SearchData*>& _list, int _maximumSize, MatchFunction _isMatching, UsedFunction _isUsed, CreateFunction _create)
+	{
+		SearchData* data = nullptr;
+		for (auto it = _list.begin(); it != _list.end(); ++it)
+		{
+			if (_isMatching(*it))
+			{
+				data = *it;
+				_list.erase(it);
+				break;
+			}
+		}
+
+		if (data == nullptr)
+		{
+			if ((int)_list.size() >= _maximumSize)
+			{
+				for (auto it = _list.begin(); it != _list.end(); ++it)
+				{
+					if (!_isUsed(*it))
+					{
+						delete (*it);
+						_list.erase(it);
+						break;
+					}
+				}
+			}
+
+			data = _create();
+		}
+
+		_list.push_back(data);
+		return data;
+	}
+
+	JumpPointTable* PathFinder::getJumpPointTable(const PathParam* _parameters)
+	{
+		MoveRule moveRule(_parameters);
+
+		JumpPointTable* jumpPointTable = findSearchData(mJumpPointTableList, MAXIMUM_JUMP_POINT_TABLES,
+			[&](const JumpPointTable* _table) { return _table->getMoveRule() == moveRule; },
+			[&](const JumpPointTable* _table)
+			{
+				for (auto state = mAStarStateList.begin(); state != mAStarStateList.end(); ++state)
+					if ((*state)->jumpPointTable == _table)
+						return true;
+				return false;
+			},
+			[&]() { return new JumpPointTable(moveRule); });
+
+		// The worker threads must not read the tables while one is built
+		if (jumpPointTable->isDirty())
+		{
+			mGridLock.lockWrite();
+			jumpPointTable->build(mGrid);
+			mGridLock.unlockWrite();
+		}
+
+		return jumpPointTable;
+	}
+
+	ClusterGraph* PathFinder::getClusterGraph(const PathParam* _parameters)
+	{
+		MoveRule moveRule(_parameters);
+		bool allowDiagonalMovements = _parameters->allowDiagonalMovements;
+
+		ClusterGraph* clusterGraph = findSearchData(mClusterGraphList, MAXIMUM_CLUSTER_GRAPHS,
+			[&](const ClusterGraph* _graph) { return _graph->getMoveRule() == moveRule && _graph->allowsDiagonalMovements() == allowDiagonalMovements; },
+			[&](const ClusterGraph* _graph)
+			{
+				for (auto state = mAStarStateList.begin(); state != mAStarStateList.end(); ++state)
+					if ((*state)->clusterGraph == _graph)
+						return true;
+				return false;
+			},
+			[&]() { return new ClusterGraph(moveRule, allowDiagonalMovements); });
+
+		// Only the clusters where the map has changed are built again
+		if (clusterGraph->isDirty())
+		{
+			mGridLock.lockWrite();
+			clusterGraph->update(mGrid);
+			mGridLock.unlockWrite();
+		}
+
+		return clusterGraph;
+	}
+
+	TraversalProfile* PathFinder::getTraversalProfile(const PathParam* _parameters)
+	{
+		MoveRule moveRule(_parameters);
+
+		TraversalProfile* traversalProfile = findSearchData(mTraversalProfileList, MAXIMUM_TRAVERSAL_PROFILES,
+			[&](const TraversalProfile* _profile) { return _profile->getMoveRule() == moveRule; },
+			[&](const TraversalProfile* _profile)
+			{
+				for (auto state = mAStarStateList.begin(); state != mAStarStateList.end(); ++state)
+					if ((*state)->traversalProfile == _profile)
+						return true;
+				return false;
+			},
+			[&]() { return new TraversalProfile(moveRule); });
+
+		// The worker threads must not read the masks while they are computed
+		if (traversalProfile->isDirty())
+		{
+			mGridLock.lockWrite();
+			traversalProfile->build(mGrid);
+			mGridLock.unlockWrite();
+		}
+
+		return traversalProfile;
+	}
+
+	LandmarkTable* PathFinder::getLandmarkTable(const PathParam* _parameters)
+	{
+		MoveRule moveRule(_parameters);
+		bool allowDiagonalMovements = _parameters->allowDiagonalMovements;
+		const TraversalProfile* traversalProfile = getTraversalProfile(_parameters);
+
+		LandmarkTable* landmarkTable = findSearchData(mLandmarkTableList, MAXIMUM_LANDMARK_TABLES,
+			[&](const LandmarkTable* _table) { return _table->getMoveRule() == moveRule && _table->allowsDiagonalMovements() == allowDiagonalMovements; },
+			[&](const LandmarkTable* _table)
+			{
+				for (auto state = mAStarStateList.begin(); state != mAStarStateList.end(); ++state)
+					if ((*state)->landmarkTable == _table)
+						return true;
+				return false;
+			},
+			[&]() { return new LandmarkTable(moveRule, allowDiagonalMovements); });
+
+		// The worker threads must not read the costs while they are computed
+		if (landmarkTable->isDirty() || landmarkTable->isStale())
+		{
+			mGridLock.lockWrite();
+			if (landmarkTable->isDirty())
+				landmarkTable->build(*traversalProfile);
+			else
+				landmarkTable->refresh(*traversalProfile);
+			mGridLock.unlockWrite();
+		}
+
+		return landmarkTable;
+	}
+
+	bool PathFinder::canReach(const PathParam* _parameters)
+	{
+		// The components would need the whole map
+		if (mIsLazyLoading)
+			return true;
+
+		return getComponentMap(_parameters)->canReach(mGrid,
+			index(_parameters->startPosition.x, _parameters->startPosition.y),
+			index(_parameters->endPosition.x, _parameters->endPosition.y));
+	}
+
+	ComponentMap* PathFinder::getComponentMap(const PathParam* _parameters)
+	{
+		MoveRule moveRule(_parameters);
+		bool allowDiagonalMovements = _parameters->allowDiagonalMovements;
+
+		// The components are only read by the main thread, they are never used by a running search
+		ComponentMap* componentMap = findSearchData(mComponentMapList, MAXIMUM_COMPONENT_MAPS,
+			[&](const ComponentMap* _map) { return _map->getMoveRule() == moveRule && _map->allowsDiagonalMovements() == allowDiagonalMovements; },
+			[](const ComponentMap*) { return false; },
+			[&]() { return new ComponentMap(moveRule, allowDiagonalMovements); });
+
+		if (componentMap->isDirty())
+			componentMap->build(mGrid);
+
+		return componentMap;
+	}
+
+	void PathFinder::setCellsChanged(int _x, int _y, int _width, int _depth)
+	{
+		// The paths in the cache are forgotten with the next use
+		++mMapVersion;
+
+		// Only the jumps leading to the changed cells are computed again
+		for (auto it = mJumpPointTableList.begin(); it != mJumpPointTableList.end(); ++it)
+			(*it)->setCellsChanged(mGrid, _x, _y, _width, _depth);
+
+		for (auto it = mClusterGraphList.begin(); it != mClusterGraphList.end(); ++it)
+			(*it)->setCellsChanged(_x, _y, _width, _depth);
+
+		for (auto it = mReplanningSearchList.begin(); it != mReplanningSearchList.end(); ++it)
+			(*it)->setCellsChanged(_x, _y, _width, _depth);
+
+		for (auto it = mFlowFieldList.begin(); it != mFlowFieldList.end(); ++it)
+			(*it)->setCellsChanged(_x, _y, _width, _depth);
+
+		for (auto it = mComponentMapList.begin(); it != mComponentMapList.end(); ++it)
+			(*it)->setCellsChanged(mGrid, _x, _y, _width, _depth);
+
+		// The profiles stay up to date, the searches using them can go on
+		for (auto it = mTraversalProfileList.begin(); it != mTraversalProfileList.end(); ++it)
+			(*it)->setCellsChanged(mGrid, _x, _y, _width, _depth);
+
+		// The old costs of the landmarks still guide the searches, they are refreshed with the next ones
+		for (auto it = mLandmarkTableList.begin(); it != mLandmarkTableList.end(); ++it)
+			(*it)->setCellsChanged();
+	}
+
+	void PathFinder::loadPages(const vector<int>& _pageList, bool _isParallel)
+	{
+		// Only the main thread loads and unloads the pages, their state is read without the lock
+		vector<int> pageList;
+		for (auto it = _pageList.begin(); it != _pageList.end(); ++it)
+			if (!mGrid.isPageLoaded(*it))
+				pageList.push_back(*it);
+		sort(pageList.begin(), pageList.end());
+		pageList.erase(unique(pageList.begin(), pageList.end()), pageList.end());
+		if (pageList.empty())
+			return;
+
+		// Reading the cubes of the world is most of the loading, so the pages of the whole map are shared by threads
+		// Each page is read with one call and written to its own cells of the grid
+		int numberPage = (int)pageList.size();
+		atomic<int> nextPage(0);
+
+		auto readPages = [this, &pageList, numberPage, &nextPage]()
+		{
+			vector<int> heightList(NavigationGrid::PAGE_AREA, 0);
+			vector<NYCubeType> typeList(NavigationGrid::PAGE_AREA, CUBE_AIR);
+
+			for (int n = nextPage++; n < numberPage; n = nextPage++)
+			{
+				int x, y, width, depth;
+				NavigationGrid::getPageBounds(pageList[n], x, y, width, depth);
+				mGridSource->readColumns(x, y, width, depth, heightList.data(), typeList.data());
+				mGrid.setColumns(x, y, width, depth, heightList.data(), typeList.data());
+			}
+		};
+
+		int numberThread = (mNumberInitializeThreads > 0) ? mNumberInitializeThreads : (int)thread::hardware_concurrency();
+		numberThread = _isParallel ? max(1, min(numberThread, numberPage)) : 1;
+		if (numberThread == 1)
+		{
+			readPages();
+		}
+		else
+		{
+			ThreadPool pool(numberThread);
+			for (int n = 0; n < numberThread; ++n)
+				pool.addTask(readPages);
+			pool.waitUntilIdle();
+		}
+
+		// The worker threads must not search while the pages become ready
+		mGridLock.lockWrite();
+
+		for (auto it = pageList.begin(); it != pageList.end(); ++it)
+		{
+			mGrid.setPageLoaded(*it);
+			mPageLastUseList[*it] = mFrameNumber;
+		}
+
+		// The masks of the cells next to the new pages change too, the map itself has not changed so the version stays the same
+		for (auto it = mTraversalProfileList.begin(); it != mTraversalProfileList.end(); ++it)
+		{
+			for (auto page = pageList.begin(); page != pageList.end(); ++page)
+			{
+				int x, y, width, depth;
+				NavigationGrid::getPageBounds(*page, x, y, width, depth);
+				(*it)->setCellsChanged(mGrid, x, y, width, depth);
+			}
+		}
+
+		mGridLock.unlockWrite();
+	}
+
+	void PathFinder::loadAllPages()
+	{
+		if (mGrid.isComplete())
+			return;
+
+		vector<int> pageList;
+		for (int pageY = 0; pageY < NavigationGrid::getNumberPageY(); ++pageY)
+			for (int pageX = 0; pageX < NavigationGrid::getNumberPageX(); ++pageX)
+				pageList.push_back(NavigationGrid::getPage(pageX, pageY));
+		loadPages(pageList, true);
+	}
+
+	void PathFinder::loadMissingPage(AStarState* _state)
+	{
+		if (_state->missingPage == -1)
+			return;
+
+		// A page is ready once the pages around it are loaded, its cells on the border move to them
+		int pageX = NavigationGrid::getPageX(_state->missingPage);
+		int pageY = NavigationGrid::getPageY(_state->missingPage);
+		_state->missingPage = -1;
+
+		vector<int> pageList;
+		for (int y = max(0, pageY - 1); y <= min(NavigationGrid::getNumberPageY() - 1, pageY + 1); ++y)
+			for (int x = max(0, pageX - 1); x <= min(NavigationGrid::getNumberPageX() - 1, pageX + 1); ++x)
+				pageList.push_back(NavigationGrid::getPage(x, y));
+		loadPages(pageList, false);
+	}
+
+	void PathFinder::setPagesUsed(const AStarState* _state)
+	{
+		if (_state->exploredMinX > _state->exploredMaxX)
+			return;
+
+		// The open nodes can be on the pages next to the explored area, and these pages need the ones around them to be ready
+		int firstX = max(0, _state->exploredMinX / NavigationGrid::PAGE_SIZE - 2);
+		int firstY = max(0, _state->exploredMinY / NavigationGrid::PAGE_SIZE - 2);
+		int lastX = min(NavigationGrid::getNumberPageX() - 1, _state->exploredMaxX / NavigationGrid::PAGE_SIZE + 2);
+		int lastY = min(NavigationGrid::getNumberPageY() - 1, _state->exploredMaxY / NavigationGrid::PAGE_SIZE + 2);
+		for (int pageY = firstY; pageY <= lastY; ++pageY)
+			for (int pageX = firstX; pageX <= lastX; ++pageX)
+				mPageLastUseList[NavigationGrid::getPage(pageX, pageY)] = mFrameNumber;
+	}
+
+	void PathFinder::unloadPages()
+	{
+		if (!mIsLazyLoading || mMaximumNumberLoadedPages <= 0 || mGrid.getNumberLoadedPage() <= mMaximumNumberLoadedPages)
+			return;
+
+		// The data built on the whole map, the snapshot and the bidirectional searches need every page
+		if (mSnapshot != nullptr || !mJumpPointTableList.empty() || !mClusterGraphList.empty() || !mLandmarkTableList.empty() ||
+			!mComponentMapList.empty() || !mFlowFieldList.empty() || !mReplanningSearchList.empty())
+			return;
+
+		for (auto it = mAStarStateList.begin(); it != mAStarStateList.end(); ++it)
+			if ((*it)->reverseState != nullptr)
+				return;
+
+		// The worker threads must not search while pages are unloaded
+		mGridLock.lockWrite();
+
+		// The pages of the running searches are kept, the others are unloaded from the least recently used one
+		for (auto it = mAStarStateList.begin(); it != mAStarStateList.end(); ++it)
+			setPagesUsed(*it);
+
+		vector<pair<int, int>> candidateList;
+		for (int pageY = 0; pageY < NavigationGrid::getNumberPageY(); ++pageY)
+		{
+			for (int pageX = 0; pageX < NavigationGrid::getNumberPageX(); ++pageX)
+			{
+				int page = NavigationGrid::getPage(pageX, pageY);
+				if (mGrid.isPageLoaded(page) && mPageLastUseList[page] != mFrameNumber)
+					candidateList.push_back(make_pair(mPageLastUseList[page], page));
+			}
+		}
+		sort(candidateList.begin(), candidateList.end());
+
+		// An obstacle is only kept by the grid, its page would lose it
+		for (auto it = candidateList.begin(); it != candidateList.end() && mGrid.getNumberLoadedPage() > mMaximumNumberLoadedPages; ++it)
+		{
+			if (mGrid.hasObstacleInPage((*it).second))
+				continue;
+
+			mGrid.unloadPage((*it).second);
+			for (auto profile = mTraversalProfileList.begin(); profile != mTraversalProfileList.end(); ++profile)
+				(*profile)->unloadPage((*it).second);
+		}
+
+		mGridLock.unlockWrite();
+	}
+
+	void PathFinder::releaseColdStates()
+	{
+		for (auto it = mFreeAStarStateList.begin(); it != mFreeAStarStateList.end(); ++it)
+			if (!(*it)->isMemoryReleased && mFrameNumber - (*it)->releaseFrame >= COLD_STATE_FRAMES)
+				(*it)->releaseMemory();
+	}
+
+	bool PathFinder::isPathWalkable(const PathParam* _parameters, const vector<WorldPosition>& _waypointsList) const
+	{
+		if (!mIsInitialized)
+			return false;
+
+		// Only the main thread changes the map, it is read without the lock
+		MoveRule moveRule(_parameters);
+		for (int n = 0; n < (int)_waypointsList.size(); ++n)
+		{
+			const WorldPosition& waypoint = _waypointsList[n];
+			if (!NavigationGrid::isInRange(waypoint.x, waypoint.y) || !mGrid.isPageLoaded(NavigationGrid::getPage(index(waypoint.x, waypoint.y))))
+				return false;
+
+			// The waypoints added to climb or fall stay on the cell of the previous one
+			if (n == 0 || (waypoint.x == _waypointsList[n - 1].x && waypoint.y == _waypointsList[n - 1].y))
+				continue;
+
+			int distanceX = abs(waypoint.x - _waypointsList[n - 1].x);
+			int distanceY = abs(waypoint.y - _waypointsList[n - 1].y);
+			if (distanceX > 1 || distanceY > 1 || (distanceX == 1 && distanceY == 1 && !_parameters->allowDiagonalMovements))
+				return false;
+
+			if (!moveRule.canMove(mGrid, index(_waypointsList[n - 1].x, _waypointsList[n - 1].y), index(waypoint.x, waypoint.y)))
+				return false;
+		}
+
+		return true;
+	}
+
+	size_t PathFinder::getMemorySize() const
+	{
+		size_t memorySize = mGrid.getMemorySize();
+
+		for (auto it = mTraversalProfileList.begin(); it != mTraversalProfileList.end(); ++it)
+			memorySize += (*it)->getMemorySize(mGrid);
+
+		for (auto it = mComponentMapList.begin(); it != mComponentMapList.end(); ++it)
+			memorySize += (*it)->getMemorySize();
+
+		for (auto it = mJumpPointTableList.begin(); it != mJumpPointTableList.end(); ++it)
+			memorySize += (*it)->getMemorySize();
+
+		for (auto it = mClusterGraphList.begin(); it != mClusterGraphList.end(); ++it)
+			memorySize += (*it)->getMemorySize();
+
+		for (auto it = mLandmarkTableList.begin(); it != mLandmarkTableList.end(); ++it)
+			memorySize += (*it)->getMemorySize();
+
+		return memorySize;
+	}
+
+	bool PathFinder::constructPath(AStarState *_state, long _maximumTimeAllowed)
+	{
+		vector<int> posX, posY;
+
+		_state->isPathGenerated = false;
+
+		// Get the list of every point in the path
+		_state->getListPoint(posX, posY);
+
+		if (!addWaypoints(posX, posY, _state->temporaryWaypointsList, _maximumTimeAllowed))
+			return false;
+
+		_state->result->waypointsList = _state->temporaryWaypointsList;
+		_state->isPathGenerated = true;
+		return true;
+	}
+
+	bool PathFinder::addWaypoints(const vector<int>& _posX, const vector<int>& _posY, vector<WorldPosition>& _waypointsList, long _maximumTimeAllowed)
+	{
+		int x, y, z;
+		int nextX = 0, nextY = 0, nextZ = 0;
+
+		if (_posX.size() > 0)
+		{
+			nextX = _posX[_posX.size() - 1];
+			nextY = _posY[_posY.size() - 1];
+			nextZ = mGrid.getHeight(index(nextX, nextY));
+		}
+
+		for (int n = (int)_posX.size() - 1; n >= 0; --n)
+		{
+			long long startTime = mTimer->getTimeMicroSeconds();
+
+			// We check the time spent every after nodes
 			if (_maximumTimeAllowed > 0)
 				if (mTimer->getTimeMicroSeconds() - startTime >= _maximumTimeAllowed)
 					return false;
@@ -492,26 +2253,24 @@ namespace fournier
 			y = nextY;
 			z = nextZ;
 
-			_state->temporaryWaypointsList.push_back(WorldPosition(x, y, z));
+			_waypointsList.push_back(WorldPosition(x, y, z));
 
 			// If the next point is lower or higher than the next, add another point at the top of the actual or next point
 			// to have a path where all point are aligned with the voxel grid
 			if (n > 0)
 			{
-				nextX = posX[n - 1];
-				nextY = posY[n - 1];
-				nextZ = mHeightList[index(nextX, nextY)];
+				nextX = _posX[n - 1];
+				nextY = _posY[n - 1];
+				nextZ = mGrid.getHeight(index(nextX, nextY));
 
 				if (z < nextZ)
-					_state->temporaryWaypointsList.push_back(WorldPosition(x, y, nextZ));
+					_waypointsList.push_back(WorldPosition(x, y, nextZ));
 				else if (z > nextZ)
-					_state->temporaryWaypointsList.push_back(WorldPosition(nextX, nextY, z));
+					_waypointsList.push_back(WorldPosition(nextX, nextY, z));
 
 			}
 		}
 
-		_state->result->waypointsList = _state->temporaryWaypointsList;
-		_state->isPathGenerated = true;
 		return true;
 	}
 }
\ No newline at end of file
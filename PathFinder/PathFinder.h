@@ -12,30 +12,48 @@
 #define __PATHFINDER_H__
 
 #include <vector>
-#include <bitset>
 #include <algorithm>
-#include "../world.h"
+#include <atomic>
+#include <climits>
+#include <mutex>
+#include "PathFinderConfig.h"
+#include "IndexedHeap.h"
+#include "BucketQueue.h"
+#include "NavigationGrid.h"
+#include "JumpPointTable.h"
+#include "ClusterGraph.h"
+#include "ReplanningSearch.h"
+#include "FlowField.h"
+#include "ComponentMap.h"
+#include "TraversalProfile.h"
+#include "LandmarkTable.h"
+#include "NeighbourEvaluator.h"
+#include "NodeRecord.h"
+#include "PathCache.h"
+#include "ThreadPool.h"
 #include "PathParam.h"
 #include "PathResult.h"
+#include "PathBatchResult.h"
 
 class NYWorld;
-class NYTimer;
-enum NYCubeType;
 
 using namespace std;
 
 namespace fournier
 {
 	class PreciseTimer;
+	class GridSource;
+	class NavigationSnapshot;
 	struct WorldPosition;
 
 	/// <summary>
 	/// Singleton used to find a path between two cube of our voxel world.
-	/// The path finding is done in a NYWorld using the A* algorithm.
-	/// The actual implementation do not support a voxel world with caves nor changing wolrd.
+	/// The path finding is done in a NYWorld, or any other GridSource, using the A* algorithm.
+	/// The actual implementation do not support a voxel world with caves. The changes of the world are given with setColumnsChanged().
 	/// 
 	/// Before using the PathFinder initialize(NYWorld*) must be called with the instance of the NYWorld.
 	/// This will construct an internal 2D representation of the world where each cell is the topmost cube of the voxel world's column.
+	/// When compiled with PATHFINDER_HEADLESS, the engine is not needed and the world is given by a GridSource or by raw arrays.
 	/// </summary>
 	class PathFinder
 	{
@@ -53,12 +71,53 @@ namespace fournier
 		/// </summary>
 		void reset();
 
+#ifndef PATHFINDER_HEADLESS
 		/// <summary>
 		/// Initialize the Pathfinder with the actual state of the world.
 		/// If the Pathfinder is already initialized, nothing will be done.
 		/// </summary>
 		/// <param name="_world">NYWorld used to define the state of the world.</param>
 		void initialize(NYWorld* _world);
+#endif
+
+		/// <summary>
+		/// Initialize the Pathfinder with the columns given by a GridSource, the size of the map is the one of the source.
+		/// The columns are read page by page, on several threads, see setNumberInitializeThreads().
+		/// With setLazyLoading(), nothing is read yet: the pages are read when the searches reach them.
+		/// If the Pathfinder is already initialized, nothing will be done.
+		/// </summary>
+		/// <param name="_gridSource">Source used to read the state of the world. It must stay alive as long as the PathFinder uses it.</param>
+		void initialize(GridSource* _gridSource);
+
+		/// <summary>
+		/// Initialize the Pathfinder with a snapshot saved by saveSnapshot(), or with the GridSource if the snapshot is missing or stale.
+		/// The snapshot is mapped in memory and used without being copied, the searches can start right away.
+		/// If the Pathfinder is already initialized, nothing will be done.
+		/// </summary>
+		/// <param name="_gridSource">Source used to read the state of the world when the snapshot cannot be used. It must stay alive as long as the PathFinder uses it.</param>
+		/// <param name="_snapshotPath">Path of the snapshot file.</param>
+		/// <param name="_worldVersion">Version of the actual world, any value that changes when the world changes (a seed, the date of the save...).</param>
+		/// <returns>True if the map comes from the snapshot, false if it was read from the GridSource.</returns>
+		bool initialize(GridSource* _gridSource, const char* _snapshotPath, unsigned long long _worldVersion);
+
+		/// <summary>
+		/// Save the map and the data derived from it in a snapshot, to be given to initialize() on the next start.
+		/// The move masks and components of the MoveRules used so far are saved, with the ones of the given parameters.
+		/// </summary>
+		/// <param name="_path">Path of the snapshot file.</param>
+		/// <param name="_worldVersion">Version of the world the map was read from, see initialize().</param>
+		/// <param name="_parametersList">Parameters of the searches expected on the next start.</param>
+		/// <returns>False if the PathFinder is not initialized or if the file could not be written.</returns>
+		bool saveSnapshot(const char* _path, unsigned long long _worldVersion, const vector<const PathParam*>& _parametersList);
+
+		/// <summary>
+		/// Initialize the Pathfinder directly with the topmost cube of each column, for a map of MAT_SIZE_CUBES * MAT_SIZE_CUBES columns.
+		/// Both arrays contain MAT_SIZE_CUBES * MAT_SIZE_CUBES values, the column (x, y) is at the index x + y * MAT_SIZE_CUBES.
+		/// If the Pathfinder is already initialized, nothing will be done.
+		/// </summary>
+		/// <param name="_heightList">Height of the topmost cube of each column.</param>
+		/// <param name="_typeList">Type of the topmost cube of each column.</param>
+		void initialize(const int* _heightList, const NYCubeType* _typeList);
 
 		/// <summary>
 		/// Update the search actually running.
@@ -75,6 +134,18 @@ namespace fournier
 		/// <returns>Return false if an the parameters are incorects (probably the given position are outside the maps bounds).</returns>
 		bool findPath(PathParam *_parameters, PathResult *_result);
 
+		/// <summary>
+		/// Find the paths from one position to many targets with a single search, which stops when the paths to every reachable target are known.
+		/// The search expands its nodes by increasing cost (Dijkstra), so each path found is a shortest one.
+		/// The end position and the search algorithm of the parameters are not used.
+		/// </summary>
+		/// <param name="_parameters">Parameters of the paths.</param>
+		/// <param name="_targetList">Positions to find a path to.</param>
+		/// <param name="_result">Results containing the path to each target if found and some debug datas.</param>
+		/// <param name="_isWaypointsWanted">Indicate if the waypoints of the paths are needed, or only their costs.</param>
+		/// <returns>Return false if the start position is outside the map.</returns>
+		bool findPaths(PathParam *_parameters, const vector<WorldPosition>& _targetList, PathBatchResult *_result, bool _isWaypointsWanted = true);
+
 		/// <summary>
 		/// Start a search that may be split on multiple frames.
 		/// The Z value of the given starting and ending position will be set to the topmost Cube of their column if needed.
@@ -93,13 +164,146 @@ namespace fournier
 		void stopSearch(int _id);
 
 		/// <summary>
-		/// Indicate if the given position is considered as walkable or not.
-		/// Be aware that adding or removing obstacles will drop every running search.
+		/// Create a search kept between two paths to the same destination, for an agent that moves or sees the map change.
+		/// The next paths only repair the part of the search changed by the move of the start or by setObstacle().
+		/// The search uses walkableCubeTypeList, maximumJumpHeight, maximumFallHeight, allowDiagonalMovements and the start and end positions of the parameters.
+		/// </summary>
+		/// <param name="_parameters">Parameters of the path, they are not used after the call.</param>
+		/// <returns>The search, to give to replan() and destroyReplanningSearch(), or nullptr if the positions are outside the map.</returns>
+		ReplanningSearch* createReplanningSearch(const PathParam* _parameters);
+
+		/// <summary>
+		/// Find the path of a replanning search from a new start position, reusing the previous computations.
+		/// </summary>
+		/// <param name="_search">Search created by createReplanningSearch().</param>
+		/// <param name="_startPosition">Actual position of the agent.</param>
+		/// <param name="_result">Results containing the path if found and some debug datas.</param>
+		/// <returns>Return false if the start position is outside the map.</returns>
+		bool replan(ReplanningSearch* _search, const WorldPosition& _startPosition, PathResult* _result);
+
+		/// <summary>
+		/// Free a search created by createReplanningSearch().
+		/// </summary>
+		void destroyReplanningSearch(ReplanningSearch* _search);
+
+		/// <summary>
+		/// Create a flow field to one goal, shared by any number of agents going to it: each agent asks for its next move with getNextStep().
+		/// The field is computed once for all of them, as far as the agent the farthest from the goal, and repaired after setObstacle().
+		/// The field uses walkableCubeTypeList, maximumJumpHeight, maximumFallHeight, allowDiagonalMovements and the end position of the parameters.
+		/// </summary>
+		/// <param name="_parameters">Parameters of the paths, they are not used after the call.</param>
+		/// <returns>The field, to give to getNextStep() and destroyFlowField(), or nullptr if the end position is outside the map.</returns>
+		FlowField* createFlowField(const PathParam* _parameters);
+
+		/// <summary>
+		/// Get the next position on the shortest path from a position to the goal of a flow field.
+		/// </summary>
+		/// <param name="_field">Field created by createFlowField().</param>
+		/// <param name="_position">Actual position of the agent.</param>
+		/// <param name="_nextPosition">Next position, on top of the cube of the next cell. It is the actual position when the agent is on the goal.</param>
+		/// <returns>False if the position is outside the map or if the goal cannot be reached from it.</returns>
+		bool getNextStep(FlowField* _field, const WorldPosition& _position, WorldPosition& _nextPosition);
+
+		/// <summary>
+		/// Move the goal of a flow field, the field is computed again.
+		/// </summary>
+		/// <returns>False if the position is outside the map, the goal is not changed.</returns>
+		bool setFlowFieldGoal(FlowField* _field, const WorldPosition& _goalPosition);
+
+		/// <summary>
+		/// Free a flow field created by createFlowField().
+		/// </summary>
+		void destroyFlowField(FlowField* _field);
+
+		/// <summary>
+		/// Indicate if the given position is considered as walkable or not, the change and the ones queued with queueObstacle() are applied now.
+		/// Only the running searches that have reached a changed cell start again, the others continue or only add the cells that became walkable.
 		/// </summary>
 		/// <param name="_position">Position where to add or remove the obstacle.</param>
 		/// <param name="_hasObstacle">Indicate if the given position is walkable or not.</param>
 		void setObstacle(const WorldPosition& _position, bool _hasObstacle);
 
+		/// <summary>
+		/// Same as setObstacle(), but the change is applied at the beginning of the next update() with all the other queued changes.
+		/// The running searches are checked once for the whole batch.
+		/// </summary>
+		/// <param name="_position">Position where to add or remove the obstacle.</param>
+		/// <param name="_hasObstacle">Indicate if the given position is walkable or not.</param>
+		void queueObstacle(const WorldPosition& _position, bool _hasObstacle);
+
+		/// <summary>
+		/// Read again a rectangle of columns from the GridSource, after cubes were added or removed in them (a player digging or building, a chunk loaded...).
+		/// Only the columns whose topmost cube has changed are updated, the running searches are handled like with setObstacle().
+		/// Nothing is done if the PathFinder was not initialized with a GridSource or a NYWorld.
+		/// </summary>
+		/// <param name="_x">X position of the first column to read.</param>
+		/// <param name="_y">Y position of the first column to read.</param>
+		/// <param name="_width">Number of columns to read on the X axis.</param>
+		/// <param name="_depth">Number of columns to read on the Y axis.</param>
+		void setColumnsChanged(int _x, int _y, int _width, int _depth);
+
+		/// <summary>
+		/// Same as setColumnsChanged(), but the columns are read at the beginning of the next update() with all the other queued changes.
+		/// The running searches are checked once for the whole batch.
+		/// </summary>
+		void queueColumnsChanged(int _x, int _y, int _width, int _depth);
+
+		/// <summary>
+		/// Version of the map, changed each time a cell changes. The paths found on an older version may cross cells that are not walkable any more.
+		/// </summary>
+		inline unsigned int getMapVersion() const { return mMapVersion; }
+
+		/// <summary>
+		/// Check that a path can be walked on the actual map: each waypoint is on the cell of the previous one or on one of its neighbours,
+		/// and the moves between the cells are allowed by the parameters. It must be called from the thread calling update().
+		/// </summary>
+		/// <param name="_parameters">Parameters of the path, only the moves they allow are used.</param>
+		/// <param name="_waypointsList">Waypoints of the path, as given in PathResult.</param>
+		/// <returns>False if a move is blocked, or if the path crosses a page that is not loaded.</returns>
+		bool isPathWalkable(const PathParam* _parameters, const vector<WorldPosition>& _waypointsList) const;
+
+		/// <summary>
+		/// Number of bytes allocated for the map and the data built from it for the searches (masks, components, jump tables, graphs and landmarks).
+		/// Only the loaded pages of the map and of the masks are counted. The states of the searches and the memory of a snapshot are not counted.
+		/// </summary>
+		size_t getMemorySize() const;
+
+		/// <summary>
+		/// Read the pages of the map only when a search first reaches them, instead of the whole map in initialize().
+		/// The searches needing the whole map (Jump Point, hierarchical, bidirectional, landmarks, flow fields, replanning searches, findPaths() and snapshots)
+		/// read every page first, and the connected components are not used to skip the searches.
+		/// Must be called before initialize().
+		/// </summary>
+		void setLazyLoading(bool _isLazyLoading);
+
+		inline bool isLazyLoading() const { return mIsLazyLoading; }
+
+		/// <summary>
+		/// Number of pages kept in memory with lazy loading, the ones not used for the longest time are unloaded in update() beyond it.
+		/// The pages reached by a running search and the pages holding obstacles set with setObstacle() are kept.
+		/// Nothing is unloaded while a jump table, an abstract graph, a landmark table, a flow field or a replanning search exists, they use the whole map.
+		/// </summary>
+		/// <param name="_numberPage">Maximum number of pages, 0 (by default) to never unload them.</param>
+		void setMaximumNumberLoadedPages(int _numberPage);
+
+		/// <summary>
+		/// Number of pages of the map read from the GridSource, see NavigationGrid::PAGE_SIZE.
+		/// </summary>
+		inline int getNumberLoadedPages() const { return mGrid.getNumberLoadedPage(); }
+
+		/// <summary>
+		/// Forget the paths kept to answer the next searches, so they are all computed. Used by Benchmark to run the same queries again.
+		/// </summary>
+		inline void clearPathCache() { mPathCache.clear(); }
+
+		/// <summary>
+		/// Choose the instructions used by the A* search to evaluate the neighbours of a node.
+		/// The best ones of the processor are used by default, an instruction set the processor does not have is replaced by the best one it has.
+		/// </summary>
+		void setInstructionSet(InstructionSet _instructionSet);
+
+		inline InstructionSet getInstructionSet() const { return mInstructionSet; }
+
 		/// <summary>
 		/// Return the number of search actually running.
 		/// </summary>
@@ -126,6 +330,37 @@ namespace fournier
 		/// <returns>Number of microseconds limiting the computations' time.</returns>
 		long getAllowedComputeTimePerFrame() const;
 
+		/// <summary>
+		/// Run the searches started with startSearch() on background threads instead of the time given to update().
+		/// The callbacks are still called from update(), on the thread calling it.
+		/// Changing the number of threads waits for the searches actually running on the previous threads.
+		/// </summary>
+		/// <param name="_numberThread">Number of worker threads, 0 to run the searches in update() only.</param>
+		void setNumberWorkerThreads(int _numberThread);
+
+		/// <summary>
+		/// Number of worker threads running the searches, 0 if the searches are run in update().
+		/// </summary>
+		int getNumberWorkerThreads() const;
+
+		/// <summary>
+		/// Set the number of threads reading the GridSource in initialize(), and when pages are loaded afterwards.
+		/// </summary>
+		/// <param name="_numberThread">Number of threads, 0 (by default) for one per core of the processor.</param>
+		void setNumberInitializeThreads(int _numberThread);
+
+		/// <summary>
+		/// Latency of the last searches started with startSearch(), from the call to startSearch() to the call of the callback.
+		/// </summary>
+		/// <param name="_percentile">Percentile wanted, between 0 and 100 (50 for the median, 99 for the tail latency).</param>
+		/// <returns>Latency in microseconds, 0 if no search has finished yet.</returns>
+		long getSearchLatencyPercentile(float _percentile) const;
+
+		/// <summary>
+		/// Forget the latencies recorded so far.
+		/// </summary>
+		void clearSearchLatencies();
+
 
 	private:
 
@@ -138,24 +373,151 @@ namespace fournier
 		/// <summary>Timer used to get time in microseconds.</summary>
 		PreciseTimer* mTimer;
 
-		/// <summary>World used to find the paths.</summary>
-		NYWorld* mWorld;
+		/// <summary>Source of the world used to find the paths.</summary>
+		GridSource* mGridSource;
 
-		/// <summary>List of the topmost cube of each columns of the voxel world.</summary>
-		vector<int> mHeightList;
+		/// <summary>Source created by the PathFinder itself that must be deleted on reset, if any.</summary>
+		GridSource* mOwnedGridSource;
 
-		/// <summary>List of the type of each topmost Cube of the 2D map.</summary>
-		vector<NYCubeType> mCubeTypeList;
+		/// <summary>Height, type and obstacle of the topmost cube of each columns of the voxel world.</summary>
+		NavigationGrid mGrid;
 
-		/// <summary>List of the obstacles present in the map.</summary>
-		bitset<MAT_SIZE_CUBES * MAT_SIZE_CUBES> mObstaclesList;
+		/// <summary>Snapshot the map was loaded from, its memory is used by mGrid and some profiles and component maps. Null if the map was read from a source.</summary>
+		NavigationSnapshot* mSnapshot;
 
 		/// <summary>List of the search states actually running.</summary>
 		vector<AStarState*> mAStarStateList;
 
+		/// <summary>States of finished searches, kept to be reused by the next ones without allocating the whole map again.</summary>
+		vector<AStarState*> mFreeAStarStateList;
+
+		/// <summary>Maximum number of states kept in mFreeAStarStateList, the others are deleted.</summary>
+		static const int MAXIMUM_FREE_STATES = 8;
+
+		/// <summary>Number of update() calls after which a free state not reused gives back the memory of its nodes.</summary>
+		static const int COLD_STATE_FRAMES = 300;
+
+		/// <summary>Jump tables of the MoveRules used by the Jump Point Searches, the last used at the end.</summary>
+		vector<JumpPointTable*> mJumpPointTableList;
+
+		/// <summary>Number of jump tables kept when they are not used by a running search.</summary>
+		static const int MAXIMUM_JUMP_POINT_TABLES = 4;
+
+		/// <summary>Abstract graphs of the MoveRules used by the hierarchical searches, the last used at the end.</summary>
+		vector<ClusterGraph*> mClusterGraphList;
+
+		/// <summary>Number of abstract graphs kept when they are not used by a running search.</summary>
+		static const int MAXIMUM_CLUSTER_GRAPHS = 4;
+
+		/// <summary>Connected components of the MoveRules used by the searches, the last used at the end.</summary>
+		vector<ComponentMap*> mComponentMapList;
+
+		/// <summary>Number of component maps kept.</summary>
+		static const int MAXIMUM_COMPONENT_MAPS = 8;
+
+		/// <summary>Compiled moves of the MoveRules used by the A* searches, the last used at the end.</summary>
+		vector<TraversalProfile*> mTraversalProfileList;
+
+		/// <summary>Number of traversal profiles kept when they are not used by a running search.</summary>
+		static const int MAXIMUM_TRAVERSAL_PROFILES = 8;
+
+		/// <summary>Landmarks of the MoveRules used by the A* searches with useLandmarkHeuristic, the last used at the end.</summary>
+		vector<LandmarkTable*> mLandmarkTableList;
+
+		/// <summary>Number of landmark tables kept when they are not used by a running search, a table of a 512x512 map uses 8 MB.</summary>
+		static const int MAXIMUM_LANDMARK_TABLES = 2;
+
+		/// <summary>Obstacle changes waiting for the next update(), the index of the cell and its new state.</summary>
+		vector<pair<int, bool>> mObstacleChangeList;
+
+		/// <summary>
+		/// Rectangle of columns to read again from the GridSource.
+		/// </summary>
+		struct ColumnChange
+		{
+			int x;
+			int y;
+			int width;
+			int depth;
+		};
+
+		/// <summary>Columns changed in the world waiting for the next update().</summary>
+		vector<ColumnChange> mColumnChangeList;
+
+		/// <summary>Flow fields created by createFlowField(), told when the map changes.</summary>
+		vector<FlowField*> mFlowFieldList;
+
+		/// <summary>Instructions used to evaluate the neighbours, see setInstructionSet().</summary>
+		InstructionSet mInstructionSet;
+
+		/// <summary>Function evaluating the neighbours with mInstructionSet.</summary>
+		NeighbourEvaluator::EvaluateFunction mEvaluateNeighbours;
+
+		/// <summary>Incremented by setCellsChanged(), see getMapVersion().</summary>
+		unsigned int mMapVersion;
+
+		/// <summary>Paths found on the actual version of the map, given back to the searches asking for the same route or a part of one.</summary>
+		PathCache mPathCache;
+
+		/// <summary>Searches created by createReplanningSearch(), told when the map changes.</summary>
+		vector<ReplanningSearch*> mReplanningSearchList;
+
+		/// <summary>Number of worker threads wanted by the user.</summary>
+		int mNumberWorkerThreads;
+
+		/// <summary>Number of threads reading the GridSource in initialize(), 0 for one per core.</summary>
+		int mNumberInitializeThreads;
+
+		/// <summary>The pages are read when the searches reach them, see setLazyLoading().</summary>
+		bool mIsLazyLoading;
+
+		/// <summary>Number of pages kept in memory with lazy loading, 0 to keep them all.</summary>
+		int mMaximumNumberLoadedPages;
+
+		/// <summary>Last frame in which each page has been loaded or reached by a search, the least recently used pages are unloaded first.</summary>
+		vector<int> mPageLastUseList;
+
+		/// <summary>Threads running the searches, nullptr if they are run in update().</summary>
+		ThreadPool* mWorkerPool;
+
+		/// <summary>Held for reading by the worker threads while they search, and for writing while the map changes.</summary>
+		ReadWriteLock mGridLock;
+
+		/// <summary>States given back by the worker threads, waiting for update() to call their callback.</summary>
+		vector<AStarState*> mFinishedStateList;
+
+		/// <summary>Protect mFinishedStateList.</summary>
+		mutex mFinishedStateMutex;
+
+		/// <summary>Number of microseconds a worker thread searches before letting the map change.</summary>
+		static const long WORKER_SLICE_TIME = 1000;
+
+		/// <summary>Number of update() calls done.</summary>
+		int mFrameNumber;
+
+		/// <summary>Latency of the last LATENCY_WINDOW searches, in microseconds.</summary>
+		vector<long> mLatencyList;
+
+		/// <summary>Number of latencies recorded, used to find the oldest one in mLatencyList.</summary>
+		int mNumberLatencyRecorded;
+
+		static const int LATENCY_WINDOW = 1024;
+
+		/// <summary>Minimum number of microseconds given to a search when the time of a frame is shared.</summary>
+		static const long MINIMUM_SLICE_TIME = 200;
+
+		/// <summary>Searches whose ends are closer than this Manhattan distance are computed before the long ones.</summary>
+		static const int SHORT_QUERY_DISTANCE = 32;
+
 		/// <summary>Number of search done since the PathFinder has been initialized.</summary>
 		int mNumberSearchDone;
 
+		/// <summary>Cost of a move to one of the 4 direct neighbours. The G and H values are fixed-point integers in this unit.</summary>
+		static const int COST_STRAIGHT = MoveRule::COST_STRAIGHT;
+
+		/// <summary>Cost of a diagonal move, sqrt(2) in fixed-point.</summary>
+		static const int COST_DIAGONAL = MoveRule::COST_DIAGONAL;
+
 
 		/// <summary>
 		/// Run the A* search.
@@ -167,6 +529,111 @@ namespace fournier
 		bool computeSearch(AStarState* _state, int& _numberNodeChecked, long _maximumTimeAllowed = -1);
 
 
+		/// <summary>
+		/// Take a state from the pool, or create a new one.
+		/// </summary>
+		AStarState* takeFreeState();
+
+		/// <summary>
+		/// Run the A* search expanding every neighbour, see computeSearch().
+		/// </summary>
+		bool computeAStarSearch(AStarState* _state, int& _numberNodeChecked, long _maximumTimeAllowed);
+
+		/// <summary>
+		/// A* search compiled for one combination of the parameters that change its inner loop, see computeAStarSearch().
+		/// </summary>
+		/// <typeparam name="ENGINE">Engine of the open list of the state.</typeparam>
+		/// <typeparam name="ALLOW_DIAGONAL">The search uses the diagonal moves.</typeparam>
+		/// <typeparam name="USE_LANDMARKS">The state has a landmark table.</typeparam>
+		/// <typeparam name="IS_BUDGETED">The time spent is checked at each node.</typeparam>
+		template<OpenListEngine ENGINE, bool ALLOW_DIAGONAL, bool USE_LANDMARKS, bool IS_BUDGETED>
+		bool computeAStarKernel(AStarState* _state, int& _numberNodeChecked, long _maximumTimeAllowed);
+
+		/// <summary>
+		/// Run the bidirectional A* search, see computeSearch().
+		/// </summary>
+		bool computeBidirectionalSearch(AStarState* _state, int& _numberNodeChecked, long _maximumTimeAllowed);
+
+		/// <summary>
+		/// Run the Jump Point Search, see computeSearch().
+		/// </summary>
+		bool computeJumpPointSearch(AStarState* _state, int& _numberNodeChecked, long _maximumTimeAllowed);
+
+		/// <summary>
+		/// Run the hierarchical search, see computeSearch().
+		/// </summary>
+		bool computeHierarchicalSearch(AStarState* _state, int& _numberNodeChecked, long _maximumTimeAllowed);
+
+		/// <summary>
+		/// Get the up to date jump table of the MoveRule of a search, it is built if needed.
+		/// </summary>
+		JumpPointTable* getJumpPointTable(const PathParam* _parameters);
+
+		/// <summary>
+		/// Get the up to date abstract graph of the MoveRule of a search, it is built if needed.
+		/// </summary>
+		ClusterGraph* getClusterGraph(const PathParam* _parameters);
+
+		/// <summary>
+		/// Get the compiled moves of the MoveRule of a search, they are computed if needed.
+		/// </summary>
+		TraversalProfile* getTraversalProfile(const PathParam* _parameters);
+
+		/// <summary>
+		/// Get the landmarks of the MoveRule of a search, they are computed if needed and one stale landmark is refreshed.
+		/// </summary>
+		LandmarkTable* getLandmarkTable(const PathParam* _parameters);
+
+		/// <summary>
+		/// Indicate if the end of a search may be reached from its start, with the connected components of its MoveRule.
+		/// When it returns false, no search is needed to know that there is no path.
+		/// </summary>
+		bool canReach(const PathParam* _parameters);
+
+		/// <summary>
+		/// Get the up to date connected components of the MoveRule of a search, they are computed if needed.
+		/// </summary>
+		ComponentMap* getComponentMap(const PathParam* _parameters);
+
+		/// <summary>
+		/// Tell the data built from the map that a rectangle of cells has changed.
+		/// Must be called with the write lock held.
+		/// </summary>
+		void setCellsChanged(int _x, int _y, int _width, int _depth);
+
+		/// <summary>
+		/// Read pages of the map from the GridSource, the pages already loaded are skipped.
+		/// The columns are read without the lock, the searches never read the cells of a page that is not loaded.
+		/// </summary>
+		/// <param name="_pageList">Pages to read.</param>
+		/// <param name="_isParallel">Share the pages between several threads, like initialize(). The few pages read while searching are read on the calling thread.</param>
+		void loadPages(const vector<int>& _pageList, bool _isParallel);
+
+		/// <summary>
+		/// Read every page not loaded yet, for the data built on the whole map.
+		/// </summary>
+		void loadAllPages();
+
+		/// <summary>
+		/// Read the page a search has stopped on, with the pages around it, so the search can go on.
+		/// </summary>
+		void loadMissingPage(AStarState* _state);
+
+		/// <summary>
+		/// Mark the pages reached by a search as used in the actual frame.
+		/// </summary>
+		void setPagesUsed(const AStarState* _state);
+
+		/// <summary>
+		/// Unload the least recently used pages beyond setMaximumNumberLoadedPages().
+		/// </summary>
+		void unloadPages();
+
+		/// <summary>
+		/// Give back the memory of the nodes of the free states not used for COLD_STATE_FRAMES frames.
+		/// </summary>
+		void releaseColdStates();
+
 		/// <summary>
 		/// Construct the list of waypoints from a result of the A* search.
 		/// </summary>
@@ -175,12 +642,98 @@ namespace fournier
 		/// <returns>Return true if the construction finished completely, false if more time is needed to complete it.</returns>
 		bool constructPath(AStarState* _state, long _maximumTimeAllowed = -1);
 
+		/// <summary>
+		/// Add the waypoints of a list of cells, with a point at each change of height so the path stays aligned with the voxel grid.
+		/// </summary>
+		/// <param name="_posX">X position of the cells, from the last one to the first one.</param>
+		/// <param name="_posY">Y position of the cells, from the last one to the first one.</param>
+		/// <param name="_maximumTimeAllowed">Number of uSeconds the algorithm can spend on this construction. If not set or negative, the algothim will take as much time as needed to complete.</param>
+		/// <returns>Return true if the construction finished completely, false if more time is needed to complete it.</returns>
+		bool addWaypoints(const vector<int>& _posX, const vector<int>& _posY, vector<WorldPosition>& _waypointsList, long _maximumTimeAllowed = -1);
+
+		/// <summary>
+		/// Get a state ready for a new search, from the pool if possible.
+		/// </summary>
+		/// <param name="_parameters">Parameters of the search.</param>
+		/// <param name="_result">Results of the search.</param>
+		AStarState* acquireState(PathParam* _parameters, PathResult* _result);
+
+		/// <summary>
+		/// Get a state for a search already finished when it starts, its path in the result or no path at all.
+		/// Unlike acquireState(), no page is read and no data is built for the search.
+		/// </summary>
+		/// <param name="_parameters">Parameters of the search.</param>
+		/// <param name="_result">Results of the search, with the waypoints of its path.</param>
+		AStarState* acquireFinishedState(PathParam* _parameters, PathResult* _result);
+
+		/// <summary>
+		/// Call the callback of a finished search and release its state.
+		/// </summary>
+		void finishSearch(AStarState* _state);
+
+		/// <summary>
+		/// Stop every running search, their parameters and result are left to the user.
+		/// Must be called with the write lock held.
+		/// </summary>
+		void dropAllSearches();
+
+		/// <summary>
+		/// Apply the changes queued by queueObstacle(), setObstacle(), queueColumnsChanged() and setColumnsChanged().
+		/// </summary>
+		void applyMapChanges();
+
+		/// <summary>
+		/// Restart or repair the running searches that depend on changed cells.
+		/// Must be called with the write lock held.
+		/// </summary>
+		void invalidateSearches(const vector<int>& _changedCellList);
+
+		/// <summary>
+		/// Start a running search again from its first node, keeping its parameters, result and callback.
+		/// </summary>
+		void restartSearch(AStarState* _state);
+
+		/// <summary>
+		/// Add a changed cell to the open list of a search if one of its closed nodes can now move to it.
+		/// </summary>
+		void repairSearch(AStarState* _state, int _cellIndex);
+
+		/// <summary>
+		/// Build again the dirty jump tables and abstract graphs.
+		/// Must be called with the write lock held.
+		/// </summary>
+		void refreshSearchData();
+
+		/// <summary>
+		/// Give a search to the worker threads.
+		/// </summary>
+		void dispatchState(AStarState* _state);
+
+		/// <summary>
+		/// Run a whole search on a worker thread and put it in the finished list.
+		/// </summary>
+		void runSearchOnWorker(AStarState* _state);
+
+		/// <summary>
+		/// Call the callbacks of the searches finished by the worker threads.
+		/// </summary>
+		void collectFinishedStates();
+
+		/// <summary>
+		/// Give back a state that is no longer used to the pool.
+		/// The parameters and result of the search are not deleted.
+		/// </summary>
+		void releaseState(AStarState* _state);
+
 
 		/// <summary>
 		/// Nested struct holding the data for one run of the A* algorithm.
 		/// This struct help us to store all the datas relative to one A* search in order to stop and resume it easily.
-		/// Instead of having a list of node with value for the g and h value, we use multiple arrays.
-		/// Each node is represented by an index helping us to find its corresponding data in the arrays.
+		/// Each node is represented by an index helping us to find its corresponding record, holding everything the search needs to know about it.
+		/// The G values are integers, see COST_STRAIGHT. The H values are only stored as part of the keys of the open list.
+		///
+		/// The states are kept in a pool and reused by the following searches.
+		/// The record of a node is only valid if its stamp matches the generation of the actual search, so a reset does not have to clear them.
 		/// </summary>
 		struct AStarState
 		{
@@ -194,207 +747,288 @@ namespace fournier
 			~AStarState()
 			{
 				// Delete everything except the parameter and result objects that do not belong to us
-				mBinaryHeapDataList.clear();
-				mClosedList.clear();
-				mParentsList.clear();
-				mGData.clear();
-				mHData.clear();
+				mBinaryHeap.clear();
+				mBucketQueue.clear();
+				mNodeList.clear();
 				temporaryWaypointsList.clear();
 			}
 
+			/// <summary>
+			/// Prepare the state for a new search, in O(1) except for the nodes still in the open list.
+			/// </summary>
+			/// <param name="_openListEngine">Data structure used to store the open list.</param>
+			inline void reset(OpenListEngine _openListEngine)
+			{
+				mBinaryHeap.clear();
+				mBucketQueue.clear();
+				mLastClosedNode = -1;
+				temporaryWaypointsList.clear();
 
-			//////// A* nodes ////////
-
-		private:
+				// The records only take memory for the nodes reached, see SparseArray
+				if (mNodeList.size() != (size_t)NavigationGrid::getNumberIndex())
+				{
+					mNodeList.assign(NavigationGrid::getNumberIndex());
+					mIsBinaryHeapAllocated = false;
+					mIsBucketQueueAllocated = false;
+				}
 
-			/// A Binary heap is used to store the data of the open list.
-			/// The STL priority_queue is an implementation of the binary heap but it can only return the top item.
-			/// We store the index of the of the node by their F value, in reverse order.
+				mGeneration += NODE_GENERATION_STEP;
+				if (mGeneration == 0)
+				{
+					mNodeList.discard();
+					mGeneration = NODE_GENERATION_STEP;
+				}
 
-			/// <summary>Contains the index of the node in the open list sorted in a way that help us finding the node with the smallest F value.</summary>
-			vector<int> mBinaryHeapDataList;
+				// Only the open list used is allocated, and it is kept for the next searches
+				mOpenListEngine = _openListEngine;
+				if (mOpenListEngine == OPEN_LIST_BUCKET_QUEUE && !mIsBucketQueueAllocated)
+				{
+					// With the octile distance, the F value of a new node is at most a diagonal move and a diagonal step of heuristic above the F value of its parent
+					mBucketQueue.initialize(NavigationGrid::getNumberIndex(), 2 * COST_DIAGONAL);
+					mIsBucketQueueAllocated = true;
+				}
+				else if (mOpenListEngine == OPEN_LIST_BINARY_HEAP && !mIsBinaryHeapAllocated)
+				{
+					mBinaryHeap.initialize(NavigationGrid::getNumberIndex());
+					mIsBinaryHeapAllocated = true;
+				}
 
-			/// <summary>Contains the index of the node in the closed list.</summary>
-			vector<int> mClosedList;
+				isAStarFinished = false;
+				isPathGenerated = false;
+				isDispatched = false;
+				isCancelled = false;
 
-			/// <summary>Contains the index of the parent of each node.</summary>
-			vector<int> mParentsList = vector<int>(MAT_SIZE_CUBES * MAT_SIZE_CUBES, -1);
+				exploredMinX = exploredMinY = INT_MAX;
+				exploredMaxX = exploredMaxY = INT_MIN;
+				missingPage = -1;
+				isMemoryReleased = false;
 
-			/// <summary>Indicate if a node is in the open list.</summary>
-			bitset<MAT_SIZE_CUBES * MAT_SIZE_CUBES> mOpenListFlags;
+				meetingNode = -1;
+				bestPathCost = INT_MAX;
 
-			/// <summary>Indicate if a node is in the closed list.</summary>
-			bitset<MAT_SIZE_CUBES * MAT_SIZE_CUBES> mClosedListFlags;
+				isConnected = false;
+				abstractPathList.clear();
+				numberRefinedEdge = 0;
+				refinedPathList.clear();
+			}
 
-			/// <summary>Cost to get to the node.</summary>
-			vector<float> mGData = vector<float>(MAT_SIZE_CUBES * MAT_SIZE_CUBES, 0);
 
-			/// <summary>Heuristic value.</summary>
-			vector<float> mHData = vector<float>(MAT_SIZE_CUBES * MAT_SIZE_CUBES, 0);
+			//////// A* nodes ////////
 
+		private:
 
-		public:
+			static const unsigned int NODE_OPEN = NodeRecord::STAMP_OPEN;
+			static const unsigned int NODE_CLOSED = NodeRecord::STAMP_CLOSED;
+			static const unsigned int NODE_GENERATION_STEP = NodeRecord::GENERATION_STEP;
 
-			inline void G(int _x, int _y, float _value) { mGData[_x + _y * MAT_SIZE_CUBES] = _value; }
-			inline float G(int _x, int _y) const { return mGData[_x + _y * MAT_SIZE_CUBES]; }
-			inline float G(int _index) const { return mGData[_index]; }
+			/// <summary>Data structure used to store the open list.</summary>
+			OpenListEngine mOpenListEngine = OPEN_LIST_BINARY_HEAP;
 
-			inline void H(int _x, int _y, float _value) { mHData[_x + _y * MAT_SIZE_CUBES] = _value; }
-			inline float H(int _x, int _y) const { return mHData[_x + _y * MAT_SIZE_CUBES]; }
-			inline float H(int _index) const { return mHData[_index]; }
+			/// <summary>Contains the index of the node in the open list sorted by their F value.</summary>
+			IndexedHeap<PATHFINDER_HEAP_ARITY> mBinaryHeap;
 
-			inline float F(int _x, int _y) const { return G(_x, _y) + H(_x, _y); }
-			inline float F(int _index) const { return G(_index) + H(_index); }
+			/// <summary>Contains the index of the node in the open list when the bucket queue is used.</summary>
+			BucketQueue mBucketQueue;
 
-			inline bool isInOpenList(int _x, int _y) { return mOpenListFlags[_x + _y * MAT_SIZE_CUBES]; }
-			inline bool isInClosedList(int _x, int _y) { return mClosedListFlags[_x + _y * MAT_SIZE_CUBES]; }
+			/// <summary>Indicate which open lists have already been allocated by a previous search.</summary>
+			bool mIsBinaryHeapAllocated = false;
+			bool mIsBucketQueueAllocated = false;
 
-			inline void addToOpenList(int _x, int _y)
-			{
-				int index = _x + _y * MAT_SIZE_CUBES;
+			/// <summary>Generation of the actual search, the two lowest bits are always 0.</summary>
+			unsigned int mGeneration = 0;
 
-				// Add the item at the end of the list
-				mBinaryHeapDataList.push_back(index);
-				float nodeF = F(index);
-				int position = (int)mBinaryHeapDataList.size();
+			/// <summary>Record of each node, allocated by the first reset().</summary>
+			SparseArray<NodeRecord> mNodeList;
 
-				while (position != 1)
-				{
-					// Check if the new node has a bigger F value than its actual parent
-					if (nodeF > F(mBinaryHeapDataList[(position / 2) - 1]))
-						break;
+			/// <summary>Last node added to the closed list, the destination if the path has been found.</summary>
+			int mLastClosedNode;
 
-					// Swap it with its parent
-					int temp = mBinaryHeapDataList[(position / 2) - 1];
-					mBinaryHeapDataList[(position / 2) - 1] = index;
-					mBinaryHeapDataList[position - 1] = temp;
 
-					position = position / 2;
-				}
+		public:
 
-				mOpenListFlags[_x + _y * MAT_SIZE_CUBES] = true;
-			}
+			inline OpenListEngine getOpenListEngine() const { return mOpenListEngine; }
 
-			inline int getBestNodeInOpenList()
-			{
-				if (mBinaryHeapDataList.size() == 0)
-					return -1;
+			inline bool isVisited(int _index) const { return (mNodeList[_index].stamp & ~(NODE_GENERATION_STEP - 1)) == mGeneration; }
 
-				int value = mBinaryHeapDataList[0];
+			inline bool isInOpenList(int _index) const { return mNodeList[_index].stamp == (mGeneration | NODE_OPEN); }
 
-				// Place the last element at the first position before removing it
-				mBinaryHeapDataList[0] = mBinaryHeapDataList[mBinaryHeapDataList.size() - 1];
-				mBinaryHeapDataList.pop_back();
+			inline bool isInClosedList(int _index) const { return mNodeList[_index].stamp == (mGeneration | NODE_CLOSED); }
 
-				int numberItem = mBinaryHeapDataList.size();
+			/// <summary>
+			/// Records of every node as three integers each, and the generation of their stamps, read by the NeighbourEvaluator.
+			/// </summary>
+			inline const int* getRecordList() const { return reinterpret_cast<const int*>(mNodeList.data()); }
 
-				// Position of the two children (index + 1)
-				int v = 1;
-				int u;
+			inline unsigned int getGeneration() const { return mGeneration; }
 
-				while (true)
-				{
-					u = v;
+			inline int G(int _index) const { return isVisited(_index) ? mNodeList[_index].g : 0; }
 
-					// Be sure to not go outside of the array
-					if (2 * u + 1 <= numberItem)
-					{
-						// Find the child with the lowest F cost
-						if (F(mBinaryHeapDataList[u - 1]) >= F(mBinaryHeapDataList[(2 * u) - 1]))
-							v = 2 * u;
-						if (F(mBinaryHeapDataList[v - 1]) >= F(mBinaryHeapDataList[(2 * u + 1) - 1]))
-							v = 2 * u + 1;
-					}
-					else if (2 * u <= numberItem) // Only one child available
-					{
-						if (F(mBinaryHeapDataList[u - 1]) >= F(mBinaryHeapDataList[(2 * u) - 1]))
-							v = 2 * u;
-					}
+			inline int getParent(int _index) const { return isVisited(_index) ? mNodeList[_index].parent : -1; }
 
-					if (u == v)
-						break;
+			/// <summary>
+			/// Read the record of a node, it is only meaningful if the node has been visited during this search.
+			/// </summary>
+			inline const NodeRecord& node(int _index) const { return mNodeList[_index]; }
 
-					// One child was better, swapt its position with the node
-					int temp = mBinaryHeapDataList[u - 1];
-					mBinaryHeapDataList[u - 1] = mBinaryHeapDataList[v - 1];
-					mBinaryHeapDataList[v - 1] = temp;
-				}
+			/// <summary>
+			/// Add the first node of the search to the open list.
+			/// </summary>
+			inline void addStartNode(int _index, int _h)
+			{
+				NodeRecord& record = mNodeList[_index];
+				record.g = 0;
+				record.parent = -1;
+				record.stamp = mGeneration | NODE_OPEN;
 
-				mOpenListFlags[value] = false;
+				if (mOpenListEngine == OPEN_LIST_BUCKET_QUEUE)
+					mBucketQueue.push(_index, _h);
+				else
+					mBinaryHeap.push(_index, _h);
 
-				return value;
+				addToExploredArea(_index);
 			}
 
-			inline bool isOpenListEmpty() { return (mBinaryHeapDataList.size() == 0); }
-
-			inline void setParent(int _x, int _y, int _parentX, int _parentY) { mParentsList[_x + _y * MAT_SIZE_CUBES] = _parentX + _parentY * MAT_SIZE_CUBES; }
+			/// <summary>
+			/// Give a new parent and G value to a node, and add it to the open list or move it if it is already in.
+			/// </summary>
+			inline void relaxNode(int _index, int _parent, int _g, int _h)
+			{
+				if (mOpenListEngine == OPEN_LIST_BUCKET_QUEUE)
+					relaxNode<OPEN_LIST_BUCKET_QUEUE>(_index, _parent, _g, _h);
+				else
+					relaxNode<OPEN_LIST_BINARY_HEAP>(_index, _parent, _g, _h);
+			}
 
-			inline void sortOpenList(int _x, int _y)
+			/// <summary>
+			/// Same as relaxNode(), for a search that knows the engine of its open list when it is compiled.
+			/// </summary>
+			template<OpenListEngine ENGINE>
+			inline void relaxNode(int _index, int _parent, int _g, int _h)
 			{
-				int index = _x + _y * MAT_SIZE_CUBES;
-				int position = -1;
+				NodeRecord& record = mNodeList[_index];
+				bool isOpen = (record.stamp == (mGeneration | NODE_OPEN));
+
+				record.g = _g;
+				record.parent = _parent;
+				record.stamp = mGeneration | NODE_OPEN;
 
-				// Find the node
-				int numberItem = mBinaryHeapDataList.size();
-				for (int n = 0; n < numberItem; ++n)
+				if (ENGINE == OPEN_LIST_BUCKET_QUEUE)
 				{
-					if (mBinaryHeapDataList[n] == index)
-					{
-						position = n + 1;
-						break;
-					}
+					if (isOpen)
+						mBucketQueue.decreaseKey(_index, _g + _h);
+					else
+						mBucketQueue.push(_index, _g + _h);
+				}
+				else
+				{
+					if (isOpen)
+						mBinaryHeap.decreaseKey(_index, _g + _h);
+					else
+						mBinaryHeap.push(_index, _g + _h);
 				}
+			}
 
-				if (position == -1)
-					return;
+			/// <summary>
+			/// Put back in the open list a node just taken from it, with the same G value, when it cannot be expanded yet.
+			/// </summary>
+			template<OpenListEngine ENGINE>
+			inline void returnToOpenList(int _index, int _h)
+			{
+				if (ENGINE == OPEN_LIST_BUCKET_QUEUE)
+					mBucketQueue.push(_index, mNodeList[_index].g + _h);
+				else
+					mBinaryHeap.push(_index, mNodeList[_index].g + _h);
+			}
 
-				float nodeF = F(index);
+			inline int getBestNodeInOpenList() { return (mOpenListEngine == OPEN_LIST_BUCKET_QUEUE) ? mBucketQueue.pop() : mBinaryHeap.pop(); }
 
-				while (position != 1)
-				{
-					// Check if the new node has a bigger F value than its actual parent
-					if (nodeF > F(mBinaryHeapDataList[(position / 2) - 1]))
-						break;
+			template<OpenListEngine ENGINE>
+			inline int getBestNodeInOpenList() { return (ENGINE == OPEN_LIST_BUCKET_QUEUE) ? mBucketQueue.pop() : mBinaryHeap.pop(); }
 
-					// Swap it with its parent
-					int temp = mBinaryHeapDataList[(position / 2) - 1];
-					mBinaryHeapDataList[(position / 2) - 1] = index;
-					mBinaryHeapDataList[position - 1] = temp;
+			/// <summary>
+			/// Get the smallest key of the open list, which must not be empty. Only available with the binary heap.
+			/// </summary>
+			inline int getBestKeyInOpenList() const { return mBinaryHeap.topKey(); }
 
-					position = position / 2;
-				}
-			}
+			inline int getOpenListSize() const { return (mOpenListEngine == OPEN_LIST_BUCKET_QUEUE) ? mBucketQueue.size() : mBinaryHeap.size(); }
 
-			inline void addToClosedList(int _x, int _y)
-			{
-				int index = _x + _y * MAT_SIZE_CUBES;
+			inline bool isOpenListEmpty() { return (mOpenListEngine == OPEN_LIST_BUCKET_QUEUE) ? mBucketQueue.isEmpty() : mBinaryHeap.isEmpty(); }
 
-				if (mClosedListFlags[index])
-					return;
+			template<OpenListEngine ENGINE>
+			inline bool isOpenListEmpty() const { return (ENGINE == OPEN_LIST_BUCKET_QUEUE) ? mBucketQueue.isEmpty() : mBinaryHeap.isEmpty(); }
 
-				mClosedList.push_back(_x + _y * MAT_SIZE_CUBES);
-				mClosedListFlags[index] = true;
+			inline void addToClosedList(int _index)
+			{
+				mNodeList[_index].stamp = mGeneration | NODE_CLOSED;
+				mLastClosedNode = _index;
 			}
 
-			inline void removeFromClosedList(int _x, int _y)
+			/// <summary>
+			/// Get every cell of the path, from the last one to the first one.
+			/// A node and its parent can be separated by a straight or diagonal line of cells (with the Jump Point Search), the cells between them are added.
+			/// The hierarchical search gives its refined path instead.
+			/// </summary>
+			inline void getListPoint(vector<int> &_posX, vector<int> &_posY)
 			{
-				int index = _x + _y * MAT_SIZE_CUBES;
+				// The path of a bidirectional search is the path from the meeting node to the end, and the one from the meeting node to the start
+				if (reverseState != nullptr)
+				{
+					if (meetingNode == -1)
+						return;
+
+					vector<int> endSideList;
+					for (int index = reverseState->getParent(meetingNode); index != -1; index = reverseState->getParent(index))
+						endSideList.push_back(index);
+
+					for (auto it = endSideList.rbegin(); it != endSideList.rend(); ++it)
+					{
+						_posX.push_back(NavigationGrid::getX(*it));
+						_posY.push_back(NavigationGrid::getY(*it));
+					}
 
-				if (!mClosedListFlags[index])
+					for (int index = meetingNode; index != -1; index = getParent(index))
+					{
+						_posX.push_back(NavigationGrid::getX(index));
+						_posY.push_back(NavigationGrid::getY(index));
+					}
 					return;
+				}
 
-				mClosedList.erase(remove(mClosedList.begin(), mClosedList.end(), _x + _y * MAT_SIZE_CUBES), mClosedList.end());
-				mClosedListFlags[index] = false;
-			}
+				if (clusterGraph != nullptr)
+				{
+					for (auto it = refinedPathList.rbegin(); it != refinedPathList.rend(); ++it)
+					{
+						_posX.push_back(NavigationGrid::getX(*it));
+						_posY.push_back(NavigationGrid::getY(*it));
+					}
+					return;
+				}
 
-			inline void getListPoint(vector<int> &_posX, vector<int> &_posY)
-			{
-				int index = mClosedList.back();
+				int index = mLastClosedNode;
 				while (index != -1)
 				{
-					_posX.push_back(index % MAT_SIZE_CUBES);
-					_posY.push_back(index / MAT_SIZE_CUBES);
-					index = mParentsList[index];
+					int x = NavigationGrid::getX(index);
+					int y = NavigationGrid::getY(index);
+					int parent = getParent(index);
+
+					_posX.push_back(x);
+					_posY.push_back(y);
+
+					if (parent != -1)
+					{
+						int parentX = NavigationGrid::getX(parent);
+						int parentY = NavigationGrid::getY(parent);
+						int stepX = (parentX > x) - (parentX < x);
+						int stepY = (parentY > y) - (parentY < y);
+
+						for (x += stepX, y += stepY; x != parentX || y != parentY; x += stepX, y += stepY)
+						{
+							_posX.push_back(x);
+							_posY.push_back(y);
+						}
+					}
+
+					index = parent;
 				}
 			}
 
@@ -409,6 +1043,24 @@ namespace fournier
 			/// <summary>Indicate if the construction of the WorldPosition is finished.</summary>
 			bool isPathGenerated;
 
+			/// <summary>Indicate if the search has been given to a worker thread.</summary>
+			bool isDispatched;
+
+			/// <summary>Set when a search given to a worker thread is stopped, the thread gives it back without finishing it.</summary>
+			atomic<bool> isCancelled;
+
+			/// <summary>Time of the call to startSearch().</summary>
+			long long startTime = 0;
+
+			/// <summary>Time at which the result is wanted, LLONG_MAX if there is no deadline.</summary>
+			long long deadlineTime = LLONG_MAX;
+
+			/// <summary>Indicate if the ends of the search are close, the short searches are computed first.</summary>
+			bool isShortQuery = false;
+
+			/// <summary>Last frame in which the search has been given some time.</summary>
+			int lastFrameComputed = 0;
+
 			/// <summary>Unique id of the search.</summary>
 			int id;
 
@@ -424,6 +1076,99 @@ namespace fournier
 			/// <summary>List of waypoint of the path.</summary>
 			vector<WorldPosition> temporaryWaypointsList;
 
+			/// <summary>Version of the map when the search started from its start node, its path is only kept in the cache if the map has not changed since.</summary>
+			unsigned int mapVersion;
+
+			/// <summary>Moves allowed from each cell, used by the A* search, nullptr for the other searches.</summary>
+			const TraversalProfile* traversalProfile = nullptr;
+
+			/// <summary>Landmarks of an A* search with useLandmarkHeuristic, nullptr for the other searches.</summary>
+			const LandmarkTable* landmarkTable = nullptr;
+
+			/// <summary>Jumps used by a Jump Point Search, nullptr for the other searches.</summary>
+			const JumpPointTable* jumpPointTable = nullptr;
+
+			/// <summary>Abstract graph used by a hierarchical search, nullptr for the other searches.</summary>
+			const ClusterGraph* clusterGraph = nullptr;
+
+			/// <summary>Search from the end to the start of a bidirectional search, nullptr for the other searches.</summary>
+			AStarState* reverseState = nullptr;
+
+			/// <summary>Node reached by both searches of a bidirectional search on the shortest path found so far, -1 if none.</summary>
+			int meetingNode = -1;
+
+			/// <summary>Cost of the path through meetingNode.</summary>
+			int bestPathCost = INT_MAX;
+
+			/// <summary>
+			/// Rectangle holding every node reached by a Jump Point Search or a hierarchical search, or expanded by an A* search.
+			/// The moves of the first ones skip cells without visiting them, so a change of the map outside of it can still change what they found:
+			/// a Jump Point Search also starts again when a jump from one of its closed nodes changes, a hierarchical search when a cluster near it changes.
+			/// The pages in it are the pages used by the search, see setMaximumNumberLoadedPages().
+			/// </summary>
+			int exploredMinX, exploredMinY, exploredMaxX, exploredMaxY;
+
+			inline void addToExploredArea(int _index)
+			{
+				addToExploredArea(NavigationGrid::getX(_index), NavigationGrid::getY(_index));
+			}
+
+			inline void addToExploredArea(int _x, int _y)
+			{
+				exploredMinX = min(exploredMinX, _x);
+				exploredMinY = min(exploredMinY, _y);
+				exploredMaxX = max(exploredMaxX, _x);
+				exploredMaxY = max(exploredMaxY, _y);
+			}
+
+			/// <summary>Page an A* search has stopped on because it is not loaded yet, -1 if none.</summary>
+			int missingPage = -1;
+
+			/// <summary>Frame in which the state has been given back to the pool.</summary>
+			int releaseFrame = 0;
+
+			/// <summary>Indicate if the nodes of the state take no memory, see releaseMemory().</summary>
+			bool isMemoryReleased = false;
+
+			/// <summary>
+			/// Give back the memory of the nodes and of the open lists, they take it again when the next searches reach their nodes.
+			/// </summary>
+			inline void releaseMemory()
+			{
+				mNodeList.discard();
+				mBinaryHeap.initialize(0);
+				mBucketQueue.initialize(0, 0);
+				mIsBinaryHeapAllocated = false;
+				mIsBucketQueueAllocated = false;
+				isMemoryReleased = true;
+			}
+
+			inline bool isInExploredArea(int _x, int _y, int _margin) const
+			{
+				return _x >= exploredMinX - _margin && _x <= exploredMaxX + _margin && _y >= exploredMinY - _margin && _y <= exploredMaxY + _margin;
+			}
+
+			/// <summary>Indicate if the start and end cells of a hierarchical search have been linked to the nodes of their clusters.</summary>
+			bool isConnected = false;
+
+			/// <summary>Cost from the start cell to each node of its cluster, -1 if it cannot be reached.</summary>
+			vector<int> startCostList;
+
+			/// <summary>Cost from each node of the cluster of the end cell to the end cell, -1 if it cannot be reached.</summary>
+			vector<int> endCostList;
+
+			/// <summary>Cost from the start cell to the end cell when they are in the same cluster, -1 otherwise.</summary>
+			int directCost = -1;
+
+			/// <summary>Nodes of the path found in the abstract graph, from the start to the end.</summary>
+			vector<int> abstractPathList;
+
+			/// <summary>Number of edges of abstractPathList already refined.</summary>
+			int numberRefinedEdge = 0;
+
+			/// <summary>Cells of the path of a hierarchical search, from the start to the end.</summary>
+			vector<int> refinedPathList;
+
 		}; // AStarState
 
 
@@ -0,0 +1,73 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __PATHFINDER_CONFIG_H__
+#define __PATHFINDER_CONFIG_H__
+
+/// The PathFinder is normally compiled inside the MyNecraft project and takes the size of the map and the types of cube from it.
+/// Defining PATHFINDER_HEADLESS allows to compile it without the engine (on a server or for benchmarks for example).
+/// In this case the height of the world and the default size of the map can be changed by defining MAT_HEIGHT_CUBES and MAT_SIZE_CUBES
+/// before including this file. The size of the map is given at runtime by the GridSource, see GridSource::getSizeX().
+
+#ifdef PATHFINDER_HEADLESS
+
+#ifndef MAT_SIZE_CUBES
+#define MAT_SIZE_CUBES 512
+#endif
+
+#ifndef MAT_HEIGHT_CUBES
+#define MAT_HEIGHT_CUBES 64
+#endif
+
+/// <summary>Types of cube, identical to the ones of the engine.</summary>
+enum NYCubeType
+{
+	CUBE_HERBE,
+	CUBE_TERRE,
+	CUBE_EAU,
+	CUBE_AIR
+};
+
+#else
+
+#include "../cube.h"
+#include "../world.h"
+
+#endif
+
+/// Size in cells of the square clusters of the hierarchical search, the clusters are the chunks of the world by default.
+#ifndef PATHFINDER_CLUSTER_SIZE
+#ifdef PATHFINDER_HEADLESS
+#define PATHFINDER_CLUSTER_SIZE 16
+#else
+#define PATHFINDER_CLUSTER_SIZE (NYChunk::CHUNK_SIZE)
+#endif
+#endif
+
+/// Side in cells of the square pages the map is made of, see NavigationGrid.
+/// The cells of a page are stored together, so are the data of the searches on it, and a page is the unit read from the world,
+/// see PathFinder::setLazyLoading(). It must be a power of 2 and at least 8. With 64 (by default) the move masks of a page fill one page of memory of 4 KB.
+#ifndef PATHFINDER_PAGE_SIZE
+#define PATHFINDER_PAGE_SIZE 64
+#endif
+
+/// Number of children of each node of the heap used as the open list of the A* search.
+/// A 4-ary heap is shallower and friendlier to the cache than the default binary heap.
+#ifndef PATHFINDER_HEAP_ARITY
+#define PATHFINDER_HEAP_ARITY 2
+#endif
+
+/// The neighbours of a node are evaluated with SSE4.1 or AVX2 instructions when the processor has them, see NeighbourEvaluator.
+/// Defining PATHFINDER_NO_SIMD keeps only the scalar code, which is always the case on other processors than x86.
+#if !defined(PATHFINDER_NO_SIMD) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define PATHFINDER_SIMD
+#endif
+
+#endif
@@ -12,13 +12,55 @@
 #define __PATH_PARAM_H__
 
 #include <vector>
-#include "../cube.h"
+#include "PathFinderConfig.h"
 #include "WorldPosition.h"
 
 using namespace std;
 
 namespace fournier
 {
+	/// <summary>
+	/// Data structure used by the A* search to store its open list.
+	/// </summary>
+	enum OpenListEngine
+	{
+		/// <summary>Heap with O(log n) operations, see PATHFINDER_HEAP_ARITY for its layout.</summary>
+		OPEN_LIST_BINARY_HEAP,
+
+		/// <summary>
+		/// Bucket queue with O(1) operations on the integer costs used by the search.
+		/// It is guided by the octile distance, its paths are always the shortest ones even with the diagonal moves.
+		/// </summary>
+		OPEN_LIST_BUCKET_QUEUE
+	};
+
+	/// <summary>
+	/// Algorithm used to find the path.
+	/// </summary>
+	enum SearchAlgorithm
+	{
+		/// <summary>A* search expanding every neighbour of each node.</summary>
+		SEARCH_ASTAR,
+
+		/// <summary>
+		/// Jump Point Search: A* search that only adds to the open list the cells where the path may turn.
+		/// It is only used with diagonal movements, the A* search is used otherwise.
+		/// </summary>
+		SEARCH_JUMP_POINT,
+
+		/// <summary>
+		/// Hierarchical search (HPA*): the path is first found between the entrances of the chunks, then refined inside each chunk.
+		/// It is much faster for long paths, but the path can be a little longer than the shortest one.
+		/// </summary>
+		SEARCH_HIERARCHICAL,
+
+		/// <summary>
+		/// Bidirectional A* search: one search from the start and one from the end, stopped when they cannot find a shorter path than the best one where they meet.
+		/// The path is always a shortest one.
+		/// </summary>
+		SEARCH_BIDIRECTIONAL
+	};
+
 	/// <summary>
 	/// Used to give a set of parameters to the PathFinder.
 	/// </summary>
@@ -46,6 +88,27 @@ namespace fournier
 		/// <summary>Maximum negative difference on the Z axis between two cube to be able to walk from one to the other.</summary>
 		int maximumFallHeight;
 
+		/// <summary>Algorithm used to find the path.</summary>
+		SearchAlgorithm searchAlgorithm = SEARCH_ASTAR;
+
+		/// <summary>Data structure used to store the open list of the search.</summary>
+		OpenListEngine openListEngine = OPEN_LIST_BINARY_HEAP;
+
+		/// <summary>
+		/// Guide the A* search with the costs to a few landmarks of the map as well as the Manhattan distance, see LandmarkTable.
+		/// The landmarks are computed with the first search using them, for each MoveRule.
+		/// </summary>
+		bool useLandmarkHeuristic = false;
+
+		/// <summary>Priority of a search started with startSearch(), the searches with the highest priority get their time first in update().</summary>
+		int priority = 0;
+
+		/// <summary>
+		/// Number of microseconds after startSearch() in which the result is wanted, or -1 if there is no deadline.
+		/// The searches with a deadline are computed first, the earliest deadline first.
+		/// </summary>
+		long deadline = -1;
+
 
 		/// <param name="_startPosition">Starting position of the path</param>
 		/// <param name="_endPosition">Ending position of the path</param>
@@ -44,6 +44,12 @@ namespace fournier
 		/// <summary>Number of node checked by the PathFinder to find this path.</summary>
 		int numberNodeChecked = 0;
 
+		/// <summary>Time in microseconds between the call to startSearch() and the call to the callback.</summary>
+		long latency = 0;
+
+		/// <summary>Indicate if the callback has been called after the deadline given in the parameters.</summary>
+		bool isDeadlineMissed = false;
+
 		~PathResult()
 		{
 			waypointsList.clear();
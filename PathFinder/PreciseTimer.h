@@ -11,36 +11,33 @@
 #ifndef __PRECISE_TIMER_H__
 #define __PRECISE_TIMER_H__
 
-#include <windows.h>
+#include <chrono>
 
 namespace fournier
 {
 
 	/// <summary>
-	/// Timer giving time in microseconds.
+	/// Timer giving time in microseconds, counted from the creation of the timer.
+	/// The time is a long long: a long only has 32 bits on Windows and would overflow after 35 minutes.
 	/// <summary>
 	class PreciseTimer
 	{
 
 	private:
 
-		LARGE_INTEGER mFrequency;
+		std::chrono::steady_clock::time_point mStartTime;
 
 
 	public:
 
 		PreciseTimer()
+			: mStartTime(std::chrono::steady_clock::now())
 		{
-			QueryPerformanceFrequency(&mFrequency);
 		}
 
-		long getTimeMicroSeconds() const
+		long long getTimeMicroSeconds() const
 		{
-			LARGE_INTEGER time;
-			QueryPerformanceCounter(&time);
-			time.QuadPart *= 1000000;
-			time.QuadPart /= mFrequency.QuadPart;
-			return (long)time.QuadPart;
+			return (long long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - mStartTime).count();
 		}
 	};
 
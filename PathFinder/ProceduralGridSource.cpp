@@ -0,0 +1,107 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "ProceduralGridSource.h"
+
+
+// Pseudo random value in [0, 1] for a point of the noise lattice
+inline float latticeValue(unsigned int _seed, int _x, int _y)
+{
+	unsigned int h = _seed ^ ((unsigned int)_x * 374761393u) ^ ((unsigned int)_y * 668265263u);
+	h = (h ^ (h >> 13)) * 1274126177u;
+	h = h ^ (h >> 16);
+	return (float)(h & 0xFFFF) / 65535.0f;
+}
+
+// Smoothly interpolated value noise, _step is the distance between two points of the lattice
+inline float valueNoise(unsigned int _seed, int _x, int _y, int _step)
+{
+	int cellX = _x / _step;
+	int cellY = _y / _step;
+	float fx = (float)(_x % _step) / _step;
+	float fy = (float)(_y % _step) / _step;
+
+	fx = fx * fx * (3.0f - 2.0f * fx);
+	fy = fy * fy * (3.0f - 2.0f * fy);
+
+	float top = latticeValue(_seed, cellX, cellY) * (1.0f - fx) + latticeValue(_seed, cellX + 1, cellY) * fx;
+	float bottom = latticeValue(_seed, cellX, cellY + 1) * (1.0f - fx) + latticeValue(_seed, cellX + 1, cellY + 1) * fx;
+	return top * (1.0f - fy) + bottom * fy;
+}
+
+
+namespace fournier
+{
+
+	ProceduralGridSource::ProceduralGridSource(unsigned int _seed, int _sizeX, int _sizeY, int _maximumHeight)
+		: mSizeX(_sizeX), mSizeY(_sizeY),
+		mHeightList(_sizeX * _sizeY, 0), mCubeTypeList(_sizeX * _sizeY, CUBE_AIR)
+	{
+		int waterHeight = _maximumHeight / 4;
+
+		for (int y = 0; y < mSizeY; ++y)
+		{
+			for (int x = 0; x < mSizeX; ++x)
+			{
+				// Large hills with some smaller bumps on them
+				float noise = valueNoise(_seed, x, y, 48) * 0.75f + valueNoise(_seed + 1, x, y, 8) * 0.25f;
+				int height = (int)(noise * _maximumHeight);
+
+				NYCubeType type = CUBE_HERBE;
+				if (height <= waterHeight)
+				{
+					height = waterHeight;
+					type = CUBE_EAU;
+				}
+				else if (valueNoise(_seed + 2, x, y, 16) > 0.7f)
+				{
+					type = CUBE_TERRE;
+				}
+
+				mHeightList[x + y * mSizeX] = height;
+				mCubeTypeList[x + y * mSizeX] = type;
+			}
+		}
+	}
+
+	void ProceduralGridSource::readColumns(int _x, int _y, int _width, int _depth, int* _heightList, NYCubeType* _typeList) const
+	{
+		for (int j = 0; j < _depth; ++j)
+		{
+			for (int i = 0; i < _width; ++i)
+			{
+				int x = _x + i;
+				int y = _y + j;
+				int n = i + j * _width;
+
+				// The columns outside of the generated world are empty
+				if (x < 0 || x >= mSizeX || y < 0 || y >= mSizeY)
+				{
+					_heightList[n] = 0;
+					_typeList[n] = CUBE_AIR;
+					continue;
+				}
+
+				_heightList[n] = mHeightList[x + y * mSizeX];
+				_typeList[n] = mCubeTypeList[x + y * mSizeX];
+			}
+		}
+	}
+
+	void ProceduralGridSource::setColumn(int _x, int _y, int _height, NYCubeType _type)
+	{
+		if (_x < 0 || _x >= mSizeX || _y < 0 || _y >= mSizeY)
+			return;
+
+		mHeightList[_x + _y * mSizeX] = _height;
+		mCubeTypeList[_x + _y * mSizeX] = _type;
+	}
+
+}
@@ -0,0 +1,69 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __PROCEDURAL_GRID_SOURCE_H__
+#define __PROCEDURAL_GRID_SOURCE_H__
+
+#include <vector>
+#include "GridSource.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// GridSource holding an in-memory world generated from a seed.
+	/// It does not need the engine and is used to run the PathFinder on a server or to benchmark it.
+	/// The generated terrain is made of hills of grass and dirt with water in the lowest parts.
+	/// </summary>
+	class ProceduralGridSource : public GridSource
+	{
+
+	private:
+
+		/// <summary>Number of columns on the X axis.</summary>
+		int mSizeX;
+
+		/// <summary>Number of columns on the Y axis.</summary>
+		int mSizeY;
+
+		/// <summary>Height of the topmost cube of each column.</summary>
+		vector<int> mHeightList;
+
+		/// <summary>Type of the topmost cube of each column.</summary>
+		vector<NYCubeType> mCubeTypeList;
+
+
+	public:
+
+		/// <param name="_seed">Seed of the generation, the same seed always gives the same world.</param>
+		/// <param name="_sizeX">Number of columns on the X axis.</param>
+		/// <param name="_sizeY">Number of columns on the Y axis.</param>
+		/// <param name="_maximumHeight">Maximum height of the generated terrain.</param>
+		ProceduralGridSource(unsigned int _seed, int _sizeX = MAT_SIZE_CUBES, int _sizeY = MAT_SIZE_CUBES, int _maximumHeight = MAT_HEIGHT_CUBES - 1);
+
+		virtual int getSizeX() const { return mSizeX; }
+
+		virtual int getSizeY() const { return mSizeY; }
+
+		virtual void readColumns(int _x, int _y, int _width, int _depth, int* _heightList, NYCubeType* _typeList) const;
+
+		/// <summary>
+		/// Change the topmost cube of a column.
+		/// </summary>
+		void setColumn(int _x, int _y, int _height, NYCubeType _type);
+
+		int getHeight(int _x, int _y) const { return mHeightList[_x + _y * mSizeX]; }
+		NYCubeType getType(int _x, int _y) const { return mCubeTypeList[_x + _y * mSizeX]; }
+	};
+
+}
+
+#endif
@@ -0,0 +1,239 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "ReplanningSearch.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+
+namespace fournier
+{
+	ReplanningSearch::ReplanningSearch(const MoveRule& _moveRule, bool _allowDiagonalMovements, int _startIndex, int _endIndex)
+		: mMoveRule(_moveRule), mAllowDiagonalMovements(_allowDiagonalMovements), mStartIndex(_startIndex), mEndIndex(_endIndex),
+		mLastStartIndex(_startIndex), mKeyModifier(0), mIsComputed(false)
+	{
+		// The search starts from the destination
+		Node& endNode = mNodeList[mEndIndex];
+		endNode.g = INFINITE_COST;
+		endNode.rhs = 0;
+		mOpenList.push(computeKey(mEndIndex, endNode));
+	}
+
+	void ReplanningSearch::setStart(int _startIndex)
+	{
+		mStartIndex = _startIndex;
+	}
+
+	void ReplanningSearch::setCellsChanged(int _x, int _y, int _width, int _depth)
+	{
+		// The moves to and from the changed cells have changed, so the neighbours are checked too
+		for (int y = max(0, _y - 1); y <= min(NavigationGrid::getSizeY() - 1, _y + _depth); ++y)
+		{
+			for (int x = max(0, _x - 1); x <= min(NavigationGrid::getSizeX() - 1, _x + _width); ++x)
+				mChangedCellList.push_back(NavigationGrid::index(x, y));
+		}
+	}
+
+	int ReplanningSearch::computeShortestPath(const NavigationGrid& _grid)
+	{
+		// The keys of the cells already in the open list were computed from the old start
+		// Adding the distance walked keeps them lower bounds of their new keys, they are updated when they come out of the list
+		if (mStartIndex != mLastStartIndex)
+		{
+			mKeyModifier += heuristic(mLastStartIndex, mStartIndex);
+			mLastStartIndex = mStartIndex;
+		}
+
+		for (auto it = mChangedCellList.begin(); it != mChangedCellList.end(); ++it)
+			updateNode(_grid, *it);
+		mChangedCellList.clear();
+
+		mIsComputed = true;
+		int numberNodeChecked = 0;
+
+		while (!mOpenList.empty())
+		{
+			OpenEntry entry = mOpenList.top();
+
+			// Skip the entries of the consistent cells and the outdated entries, and move the entries whose key has grown
+			auto it = mNodeList.find(entry.index);
+			if (it == mNodeList.end() || it->second.g == it->second.rhs)
+			{
+				mOpenList.pop();
+				continue;
+			}
+
+			OpenEntry newEntry = computeKey(entry.index, it->second);
+			if (entry > newEntry)
+			{
+				mOpenList.pop();
+				continue;
+			}
+			if (newEntry > entry)
+			{
+				mOpenList.pop();
+				mOpenList.push(newEntry);
+				continue;
+			}
+
+			// Stop when the cost of the start is known
+			auto start = mNodeList.find(mStartIndex);
+			if (start != mNodeList.end())
+			{
+				if (!(computeKey(mStartIndex, start->second) > entry) && start->second.g == start->second.rhs)
+					break;
+			}
+
+			mOpenList.pop();
+			++numberNodeChecked;
+
+			Node& node = it->second;
+			if (node.g > node.rhs)
+			{
+				node.g = node.rhs;
+				updatePredecessors(_grid, entry.index);
+			}
+			else
+			{
+				node.g = INFINITE_COST;
+				updateNode(_grid, entry.index);
+				updatePredecessors(_grid, entry.index);
+			}
+		}
+
+		return numberNodeChecked;
+	}
+
+	bool ReplanningSearch::getPath(const NavigationGrid& _grid, vector<int>& _cellList) const
+	{
+		int actualIndex = mStartIndex;
+		if (!mIsComputed || G(actualIndex) >= INFINITE_COST)
+			return false;
+
+		int directionStep = mAllowDiagonalMovements ? 1 : 2;
+
+		// Follow the neighbour with the lowest cost to the destination, a path cannot be longer than the number of cells
+		_cellList.push_back(actualIndex);
+		for (int step = 0; actualIndex != mEndIndex && step < NavigationGrid::getNumberIndex(); ++step)
+		{
+			int actualX = NavigationGrid::getX(actualIndex);
+			int actualY = NavigationGrid::getY(actualIndex);
+			int bestIndex = -1;
+			int bestCost = INFINITE_COST;
+
+			for (int direction = 0; direction < 8; direction += directionStep)
+			{
+				int neighbourX = actualX + NavigationGrid::NEIGHBOUR_X[direction];
+				int neighbourY = actualY + NavigationGrid::NEIGHBOUR_Y[direction];
+				if (!NavigationGrid::isInRange(neighbourX, neighbourY))
+					continue;
+
+				int neighbourIndex = NavigationGrid::index(neighbourX, neighbourY);
+				if (!mMoveRule.canMove(_grid, actualIndex, neighbourIndex))
+					continue;
+
+				int cost = G(neighbourIndex) + ((direction & 1) ? MoveRule::COST_DIAGONAL : MoveRule::COST_STRAIGHT);
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestIndex = neighbourIndex;
+				}
+			}
+
+			if (bestIndex == -1)
+				return false;
+
+			actualIndex = bestIndex;
+			_cellList.push_back(actualIndex);
+		}
+
+		return actualIndex == mEndIndex;
+	}
+
+	int ReplanningSearch::heuristic(int _fromIndex, int _toIndex) const
+	{
+		int distanceX = abs(NavigationGrid::getX(_fromIndex) - NavigationGrid::getX(_toIndex));
+		int distanceY = abs(NavigationGrid::getY(_fromIndex) - NavigationGrid::getY(_toIndex));
+		int diagonal = mAllowDiagonalMovements ? min(distanceX, distanceY) : 0;
+		return diagonal * MoveRule::COST_DIAGONAL + (distanceX + distanceY - 2 * diagonal) * MoveRule::COST_STRAIGHT;
+	}
+
+	ReplanningSearch::OpenEntry ReplanningSearch::computeKey(int _index, const Node& _node) const
+	{
+		OpenEntry entry;
+		entry.key2 = min(_node.g, _node.rhs);
+		entry.key1 = entry.key2 + heuristic(mStartIndex, _index) + mKeyModifier;
+		entry.index = _index;
+		return entry;
+	}
+
+	void ReplanningSearch::updateNode(const NavigationGrid& _grid, int _index)
+	{
+		if (_index == mEndIndex)
+			return;
+
+		// The cell itself is not checked, like the start of the other searches, no move can enter it if it is not walkable
+		int rhs = INFINITE_COST;
+		int x = NavigationGrid::getX(_index);
+		int y = NavigationGrid::getY(_index);
+		int directionStep = mAllowDiagonalMovements ? 1 : 2;
+
+		for (int direction = 0; direction < 8; direction += directionStep)
+		{
+			int neighbourX = x + NavigationGrid::NEIGHBOUR_X[direction];
+			int neighbourY = y + NavigationGrid::NEIGHBOUR_Y[direction];
+			if (!NavigationGrid::isInRange(neighbourX, neighbourY))
+				continue;
+
+			int neighbourIndex = NavigationGrid::index(neighbourX, neighbourY);
+			int neighbourG = G(neighbourIndex);
+			if (neighbourG >= INFINITE_COST || !mMoveRule.canMove(_grid, _index, neighbourIndex))
+				continue;
+
+			rhs = min(rhs, neighbourG + ((direction & 1) ? MoveRule::COST_DIAGONAL : MoveRule::COST_STRAIGHT));
+		}
+
+		// A cell never reached is not stored
+		auto it = mNodeList.find(_index);
+		if (it == mNodeList.end())
+		{
+			if (rhs >= INFINITE_COST)
+				return;
+
+			it = mNodeList.insert(make_pair(_index, Node())).first;
+			it->second.g = INFINITE_COST;
+		}
+
+		it->second.rhs = rhs;
+		if (it->second.g != it->second.rhs)
+			mOpenList.push(computeKey(_index, it->second));
+	}
+
+	void ReplanningSearch::updatePredecessors(const NavigationGrid& _grid, int _index)
+	{
+		int x = NavigationGrid::getX(_index);
+		int y = NavigationGrid::getY(_index);
+		int directionStep = mAllowDiagonalMovements ? 1 : 2;
+
+		for (int direction = 0; direction < 8; direction += directionStep)
+		{
+			int neighbourX = x + NavigationGrid::NEIGHBOUR_X[direction];
+			int neighbourY = y + NavigationGrid::NEIGHBOUR_Y[direction];
+			if (!NavigationGrid::isInRange(neighbourX, neighbourY))
+				continue;
+
+			int neighbourIndex = NavigationGrid::index(neighbourX, neighbourY);
+			if (mMoveRule.canMove(_grid, neighbourIndex, _index))
+				updateNode(_grid, neighbourIndex);
+		}
+	}
+
+}
@@ -0,0 +1,151 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __REPLANNING_SEARCH_H__
+#define __REPLANNING_SEARCH_H__
+
+#include <climits>
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include "PathFinderConfig.h"
+#include "NavigationGrid.h"
+#include "MoveRule.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// Search kept between two paths to the same destination, for an agent that moves or sees the map change (D* Lite).
+	/// The search goes from the destination to the agent, so the cost to the destination of every cell already explored stays valid when the agent moves.
+	/// When cells change, only the cells whose cost to the destination depends on them are computed again.
+	///
+	/// Only the explored cells are stored, so hundreds of searches can be kept alive on a big map.
+	/// The heuristic is the octile distance (the Manhattan distance without diagonal moves), the paths are always the shortest ones.
+	/// </summary>
+	class ReplanningSearch
+	{
+
+	private:
+
+		/// <summary>
+		/// Costs of an explored cell, to the destination.
+		/// g is the cost known by the search, rhs the cost computed from the neighbours. The cell is consistent when they are equal.
+		/// </summary>
+		struct Node
+		{
+			int g;
+			int rhs;
+		};
+
+		/// <summary>
+		/// Cell in the open list, with the key it had when it was added.
+		/// A cell can be in the list more than once, the entries with an outdated key are skipped.
+		/// </summary>
+		struct OpenEntry
+		{
+			int key1;
+			int key2;
+			int index;
+
+			inline bool operator>(const OpenEntry& _other) const
+			{
+				return key1 > _other.key1 || (key1 == _other.key1 && key2 > _other.key2);
+			}
+		};
+
+		/// <summary>Cost of a cell that cannot reach the destination.</summary>
+		static const int INFINITE_COST = INT_MAX / 2;
+
+		MoveRule mMoveRule;
+
+		bool mAllowDiagonalMovements;
+
+		int mStartIndex;
+
+		int mEndIndex;
+
+		/// <summary>Start cell of the last computed path, used to keep the old keys valid when the start moves.</summary>
+		int mLastStartIndex;
+
+		/// <summary>Sum of the heuristic distances walked by the start, added to every key.</summary>
+		int mKeyModifier;
+
+		bool mIsComputed;
+
+		unordered_map<int, Node> mNodeList;
+
+		priority_queue<OpenEntry, vector<OpenEntry>, greater<OpenEntry>> mOpenList;
+
+		/// <summary>Cells changed since the last computed path, with their neighbours.</summary>
+		vector<int> mChangedCellList;
+
+
+	public:
+
+		ReplanningSearch(const MoveRule& _moveRule, bool _allowDiagonalMovements, int _startIndex, int _endIndex);
+
+		inline int getEndIndex() const { return mEndIndex; }
+
+		/// <summary>
+		/// Move the start of the path, the agent position.
+		/// </summary>
+		void setStart(int _startIndex);
+
+		/// <summary>
+		/// Tell the search that a rectangle of cells has changed, they are checked with the next computeShortestPath().
+		/// </summary>
+		void setCellsChanged(int _x, int _y, int _width, int _depth);
+
+		/// <summary>
+		/// Repair the search after the changes of the start and of the map, until the cost of the start is known.
+		/// </summary>
+		/// <returns>Number of nodes checked.</returns>
+		int computeShortestPath(const NavigationGrid& _grid);
+
+		/// <summary>
+		/// Get the cells of the path from the start to the destination, computeShortestPath() must be called before.
+		/// </summary>
+		/// <returns>False if the destination cannot be reached.</returns>
+		bool getPath(const NavigationGrid& _grid, vector<int>& _cellList) const;
+
+		/// <summary>
+		/// Number of explored cells kept by the search.
+		/// </summary>
+		inline int getNumberNode() const { return mNodeList.size(); }
+
+
+	private:
+
+		int heuristic(int _fromIndex, int _toIndex) const;
+
+		inline int G(int _index) const
+		{
+			auto it = mNodeList.find(_index);
+			return (it != mNodeList.end()) ? it->second.g : INFINITE_COST;
+		}
+
+		OpenEntry computeKey(int _index, const Node& _node) const;
+
+		/// <summary>
+		/// Compute the rhs value of a cell again from its neighbours, and put it in the open list if it is not consistent.
+		/// </summary>
+		void updateNode(const NavigationGrid& _grid, int _index);
+
+		/// <summary>
+		/// Update the cells that can move to a cell.
+		/// </summary>
+		void updatePredecessors(const NavigationGrid& _grid, int _index);
+	};
+
+}
+
+#endif
@@ -0,0 +1,118 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "SparseArray.h"
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+namespace fournier
+{
+	/// <summary>
+	/// Size of a page of the system, the unit in which the memory is taken and given back.
+	/// </summary>
+	static size_t getSystemPageSize()
+	{
+		static const size_t SYSTEM_PAGE_SIZE = []()
+		{
+#ifdef _WIN32
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			return (size_t)info.dwPageSize;
+#else
+			return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+		}();
+
+		return SYSTEM_PAGE_SIZE;
+	}
+
+	void* SparseMemory::allocate(size_t _size)
+	{
+#ifdef _WIN32
+		// The committed pages only get physical memory when they are first touched
+		return VirtualAlloc(nullptr, _size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+		int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+		flags |= MAP_NORESERVE;
+#endif
+		void* data = mmap(nullptr, _size, PROT_READ | PROT_WRITE, flags, -1, 0);
+		return (data != MAP_FAILED) ? data : nullptr;
+#endif
+	}
+
+	void SparseMemory::release(void* _data, size_t _size)
+	{
+#ifdef _WIN32
+		(void)_size;
+		VirtualFree(_data, 0, MEM_RELEASE);
+#else
+		munmap(_data, _size);
+#endif
+	}
+
+	void SparseMemory::discard(void* _data, size_t _size)
+	{
+		size_t pageSize = getSystemPageSize();
+		uintptr_t start = (uintptr_t)_data;
+		uintptr_t end = start + _size;
+		uintptr_t firstPage = (start + pageSize - 1) & ~(uintptr_t)(pageSize - 1);
+		uintptr_t lastPage = end & ~(uintptr_t)(pageSize - 1);
+
+		// A range smaller than a page, or the parts of the pages shared with the values around it, are cleared by hand
+		if (firstPage >= lastPage)
+		{
+			memset(_data, 0, _size);
+			return;
+		}
+		memset(_data, 0, firstPage - start);
+		memset((void*)lastPage, 0, end - lastPage);
+
+		// The pages are given back and read as zeros again, they take memory again when they are written
+		// If the system refuses, they are cleared by hand and keep their memory
+		void* pages = (void*)firstPage;
+		size_t pagesSize = lastPage - firstPage;
+#ifdef _WIN32
+		if (!VirtualFree(pages, pagesSize, MEM_DECOMMIT))
+		{
+			memset(pages, 0, pagesSize);
+			return;
+		}
+
+		// Committed again, the pages are zeroed. They are part of the array, failing here is failing an allocation
+		if (VirtualAlloc(pages, pagesSize, MEM_COMMIT, PAGE_READWRITE) == nullptr)
+			throw std::bad_alloc();
+#elif defined(__linux__)
+		// The mapping is private and anonymous, Linux fills its pages with zeros when they are touched again
+		if (madvise(pages, pagesSize, MADV_DONTNEED) != 0)
+			memset(pages, 0, pagesSize);
+#else
+		// MADV_DONTNEED does not zero the pages on the other systems, new pages are mapped over them
+		int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED;
+#ifdef MAP_NORESERVE
+		flags |= MAP_NORESERVE;
+#endif
+		if (mmap(pages, pagesSize, PROT_READ | PROT_WRITE, flags, -1, 0) == MAP_FAILED)
+			memset(pages, 0, pagesSize);
+#endif
+	}
+
+}
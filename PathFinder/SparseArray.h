@@ -0,0 +1,134 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __SPARSE_ARRAY_H__
+#define __SPARSE_ARRAY_H__
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace fournier
+{
+	/// <summary>
+	/// Memory taken from the system as zeroed pages, which only get physical memory the first time they are written.
+	/// </summary>
+	class SparseMemory
+	{
+
+	public:
+
+		/// <summary>
+		/// Reserve a block of memory reading as zeros, nothing is written in it.
+		/// </summary>
+		/// <returns>The block, or nullptr if the system has not enough memory.</returns>
+		static void* allocate(size_t _size);
+
+		/// <summary>
+		/// Free a block given by allocate().
+		/// </summary>
+		static void release(void* _data, size_t _size);
+
+		/// <summary>
+		/// Make a range of a block read as zeros again. The pages of the system entirely inside the range are given back, the rest is cleared.
+		/// The pages the system does not take back are cleared too, they keep their memory.
+		/// </summary>
+		static void discard(void* _data, size_t _size);
+	};
+
+	/// <summary>
+	/// Array of values starting at zero, for the data of a whole map of which only a part is used:
+	/// the memory of the values never written is never taken, and discard() gives back the memory of a range.
+	/// The values are not constructed, a value whose bytes are all 0 must be valid.
+	/// </summary>
+	template <typename T>
+	class SparseArray
+	{
+		static_assert(std::is_trivial<T>::value, "The values of a SparseArray are never constructed");
+
+	private:
+
+		T* mData;
+
+		size_t mSize;
+
+
+	public:
+
+		SparseArray()
+			: mData(nullptr), mSize(0)
+		{
+		}
+
+		~SparseArray()
+		{
+			clear();
+		}
+
+		SparseArray(const SparseArray&) = delete;
+		SparseArray& operator=(const SparseArray&) = delete;
+
+		/// <summary>
+		/// Replace the array by _size values set to 0.
+		/// </summary>
+		inline void assign(size_t _size)
+		{
+			clear();
+			if (_size == 0)
+				return;
+
+			// Like the vectors it replaces, the array throws when the memory is missing
+			mData = (T*)SparseMemory::allocate(_size * sizeof(T));
+			if (mData == nullptr)
+				throw std::bad_alloc();
+			mSize = _size;
+		}
+
+		inline void clear()
+		{
+			if (mData != nullptr)
+				SparseMemory::release(mData, mSize * sizeof(T));
+			mData = nullptr;
+			mSize = 0;
+		}
+
+		/// <summary>
+		/// Set every value to 0 and give back the memory.
+		/// </summary>
+		inline void discard()
+		{
+			discard(0, mSize);
+		}
+
+		/// <summary>
+		/// Set _number values from _first to 0 and give back their memory.
+		/// </summary>
+		inline void discard(size_t _first, size_t _number)
+		{
+			if (_number > 0)
+				SparseMemory::discard(mData + _first, _number * sizeof(T));
+		}
+
+		inline size_t size() const { return mSize; }
+
+		inline bool empty() const { return mSize == 0; }
+
+		inline T* data() { return mData; }
+
+		inline const T* data() const { return mData; }
+
+		inline T& operator[](size_t _index) { return mData[_index]; }
+
+		inline const T& operator[](size_t _index) const { return mData[_index]; }
+	};
+
+}
+
+#endif
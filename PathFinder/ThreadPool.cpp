@@ -0,0 +1,117 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "ThreadPool.h"
+
+
+namespace fournier
+{
+
+	ThreadPool::ThreadPool(int _numberThread)
+		: mNumberRunningTask(0), mIsStopping(false)
+	{
+		for (int n = 0; n < _numberThread; ++n)
+			mThreadList.push_back(thread(&ThreadPool::run, this));
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			unique_lock<mutex> lock(mMutex);
+			mIsStopping = true;
+		}
+		mTaskCondition.notify_all();
+
+		for (auto it = mThreadList.begin(); it != mThreadList.end(); ++it)
+			(*it).join();
+		mThreadList.clear();
+	}
+
+	void ThreadPool::addTask(function<void()> _task)
+	{
+		{
+			unique_lock<mutex> lock(mMutex);
+			mTaskList.push_back(_task);
+		}
+		mTaskCondition.notify_one();
+	}
+
+	void ThreadPool::waitUntilIdle()
+	{
+		unique_lock<mutex> lock(mMutex);
+		while (!mTaskList.empty() || mNumberRunningTask > 0)
+			mIdleCondition.wait(lock);
+	}
+
+	void ThreadPool::run()
+	{
+		while (true)
+		{
+			function<void()> task;
+
+			{
+				unique_lock<mutex> lock(mMutex);
+				while (mTaskList.empty() && !mIsStopping)
+					mTaskCondition.wait(lock);
+
+				// The remaining tasks are done before stopping
+				if (mTaskList.empty())
+					return;
+
+				task = mTaskList.front();
+				mTaskList.pop_front();
+				++mNumberRunningTask;
+			}
+
+			task();
+
+			{
+				unique_lock<mutex> lock(mMutex);
+				--mNumberRunningTask;
+				if (mTaskList.empty() && mNumberRunningTask == 0)
+					mIdleCondition.notify_all();
+			}
+		}
+	}
+
+	void ReadWriteLock::lockRead()
+	{
+		unique_lock<mutex> lock(mMutex);
+		while (mIsWriting || mNumberWaitingWriter > 0)
+			mCondition.wait(lock);
+		++mNumberReader;
+	}
+
+	void ReadWriteLock::unlockRead()
+	{
+		unique_lock<mutex> lock(mMutex);
+		--mNumberReader;
+		if (mNumberReader == 0)
+			mCondition.notify_all();
+	}
+
+	void ReadWriteLock::lockWrite()
+	{
+		unique_lock<mutex> lock(mMutex);
+		++mNumberWaitingWriter;
+		while (mIsWriting || mNumberReader > 0)
+			mCondition.wait(lock);
+		--mNumberWaitingWriter;
+		mIsWriting = true;
+	}
+
+	void ReadWriteLock::unlockWrite()
+	{
+		unique_lock<mutex> lock(mMutex);
+		mIsWriting = false;
+		mCondition.notify_all();
+	}
+
+}
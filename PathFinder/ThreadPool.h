@@ -0,0 +1,114 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// Fixed number of threads running the tasks given to them in the order they were added.
+	/// </summary>
+	class ThreadPool
+	{
+
+	private:
+
+		/// <summary>Threads of the pool.</summary>
+		vector<thread> mThreadList;
+
+		/// <summary>Tasks waiting for a thread.</summary>
+		deque<function<void()>> mTaskList;
+
+		/// <summary>Number of tasks actually running.</summary>
+		int mNumberRunningTask;
+
+		/// <summary>Indicate that the threads must stop once the tasks waiting are done.</summary>
+		bool mIsStopping;
+
+		mutex mMutex;
+		condition_variable mTaskCondition;
+		condition_variable mIdleCondition;
+
+
+	public:
+
+		/// <param name="_numberThread">Number of threads to create.</param>
+		ThreadPool(int _numberThread);
+
+		/// <summary>
+		/// Wait for every task already added and stop the threads.
+		/// </summary>
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool& operator=(const ThreadPool &) = delete;
+
+		/// <summary>
+		/// Add a task that will be run by the first thread available.
+		/// </summary>
+		void addTask(function<void()> _task);
+
+		/// <summary>
+		/// Block until every task added has been run.
+		/// </summary>
+		void waitUntilIdle();
+
+		int getNumberThread() const { return (int)mThreadList.size(); }
+
+
+	private:
+
+		void run();
+	};
+
+	/// <summary>
+	/// Lock that can be held by multiple readers at the same time or by a single writer.
+	/// A writer waiting for the lock prevents new readers from taking it.
+	/// </summary>
+	class ReadWriteLock
+	{
+
+	private:
+
+		int mNumberReader;
+		int mNumberWaitingWriter;
+		bool mIsWriting;
+
+		mutex mMutex;
+		condition_variable mCondition;
+
+
+	public:
+
+		ReadWriteLock()
+			: mNumberReader(0), mNumberWaitingWriter(0), mIsWriting(false)
+		{
+		}
+
+		void lockRead();
+		void unlockRead();
+
+		void lockWrite();
+		void unlockWrite();
+	};
+
+}
+
+#endif
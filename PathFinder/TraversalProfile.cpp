@@ -0,0 +1,91 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#include "TraversalProfile.h"
+
+#include <algorithm>
+
+
+namespace fournier
+{
+	TraversalProfile::TraversalProfile(const MoveRule& _moveRule)
+		: mMoveRule(_moveRule), mMoveMaskList(nullptr), mIsDirty(true)
+	{
+	}
+
+	void TraversalProfile::build(const NavigationGrid& _grid)
+	{
+		mOwnedMoveMaskList.assign(NavigationGrid::getNumberIndex());
+		mMoveMaskList = mOwnedMoveMaskList.data();
+
+		// The pages not loaded yet get their masks when they are, see PathFinder::loadPages()
+		for (int page = 0; page < NavigationGrid::getNumberPage(); ++page)
+		{
+			if (!_grid.isPageLoaded(page))
+				continue;
+
+			int pageX, pageY, width, depth;
+			NavigationGrid::getPageBounds(page, pageX, pageY, width, depth);
+			for (int y = pageY; y < pageY + depth; ++y)
+				for (int x = pageX; x < pageX + width; ++x)
+					mMoveMaskList[NavigationGrid::index(x, y)] = computeMoveMask(_grid, x, y);
+		}
+
+		mIsDirty = false;
+	}
+
+	void TraversalProfile::attach(unsigned char* _moveMaskList)
+	{
+		mOwnedMoveMaskList.clear();
+		mMoveMaskList = _moveMaskList;
+		mIsDirty = false;
+	}
+
+	void TraversalProfile::setCellsChanged(const NavigationGrid& _grid, int _x, int _y, int _width, int _depth)
+	{
+		if (mIsDirty)
+			return;
+
+		// The moves to a changed cell start from the cells around it
+		int lastX = min(NavigationGrid::getSizeX() - 1, _x + _width);
+		int lastY = min(NavigationGrid::getSizeY() - 1, _y + _depth);
+		for (int y = max(0, _y - 1); y <= lastY; ++y)
+			for (int x = max(0, _x - 1); x <= lastX; ++x)
+				mMoveMaskList[NavigationGrid::index(x, y)] = computeMoveMask(_grid, x, y);
+	}
+
+	void TraversalProfile::unloadPage(int _page)
+	{
+		if (!mIsDirty && !mOwnedMoveMaskList.empty())
+			mOwnedMoveMaskList.discard((size_t)_page * NavigationGrid::PAGE_AREA, NavigationGrid::PAGE_AREA);
+	}
+
+	size_t TraversalProfile::getMemorySize(const NavigationGrid& _grid) const
+	{
+		if (mOwnedMoveMaskList.empty())
+			return 0;
+		return (size_t)_grid.getNumberLoadedPage() * NavigationGrid::PAGE_AREA * sizeof(unsigned char);
+	}
+
+	unsigned char TraversalProfile::computeMoveMask(const NavigationGrid& _grid, int _x, int _y) const
+	{
+		int actualIndex = NavigationGrid::index(_x, _y);
+		unsigned char moveMask = 0;
+		for (int direction = 0; direction < 8; ++direction)
+		{
+			int neighbourX = _x + NavigationGrid::NEIGHBOUR_X[direction];
+			int neighbourY = _y + NavigationGrid::NEIGHBOUR_Y[direction];
+			if (NavigationGrid::isInRange(neighbourX, neighbourY) && mMoveRule.canMove(_grid, actualIndex, NavigationGrid::index(neighbourX, neighbourY)))
+				moveMask |= 1 << direction;
+		}
+		return moveMask;
+	}
+
+}
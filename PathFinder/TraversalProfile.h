@@ -0,0 +1,98 @@
+// =================================================================================================
+//
+//	PathFinder
+//	Copyright 2014 FOURNIER Antoine. All Rights Reserved.
+//
+//	This program is free software. You can redistribute and/or modify it
+//	in accordance with the terms of the accompanying license agreement.
+//
+// =================================================================================================
+
+#ifndef __TRAVERSAL_PROFILE_H__
+#define __TRAVERSAL_PROFILE_H__
+
+#include "PathFinderConfig.h"
+#include "NavigationGrid.h"
+#include "SparseArray.h"
+#include "MoveRule.h"
+
+using namespace std;
+
+namespace fournier
+{
+	/// <summary>
+	/// Moves allowed by one MoveRule from every cell, compiled so the A* search reads one byte per node
+	/// instead of checking the type, the obstacle and the height of each neighbour with the parameters of the search.
+	/// The bit d of the mask of a cell is set when the move to its neighbour in the direction d is allowed, see NavigationGrid::NEIGHBOUR_X.
+	/// The diagonal moves are in the odd bits, a search without them masks them out.
+	/// </summary>
+	class TraversalProfile
+	{
+
+	public:
+
+		/// <summary>Bits of the straight moves in a mask.</summary>
+		static const unsigned char STRAIGHT_MOVES = 0x55;
+
+		/// <summary>Bits of every move in a mask.</summary>
+		static const unsigned char ALL_MOVES = 0xFF;
+
+
+	private:
+
+		MoveRule mMoveRule;
+
+		/// <summary>Mask of the allowed moves of each cell.</summary>
+		unsigned char* mMoveMaskList;
+
+		/// <summary>Masks allocated by build(), empty when the masks are the ones of a snapshot. Only the masks of the loaded pages take memory.</summary>
+		SparseArray<unsigned char> mOwnedMoveMaskList;
+
+		/// <summary>The masks have not been computed yet.</summary>
+		bool mIsDirty;
+
+
+	public:
+
+		TraversalProfile(const MoveRule& _moveRule);
+
+		inline const MoveRule& getMoveRule() const { return mMoveRule; }
+
+		inline bool isDirty() const { return mIsDirty; }
+
+		/// <summary>
+		/// Compute the mask of every cell of the loaded pages, in O(cells).
+		/// </summary>
+		void build(const NavigationGrid& _grid);
+
+		/// <summary>
+		/// Use masks stored elsewhere instead of computing them, see NavigationSnapshot. They are not copied and must stay valid as long as the profile.
+		/// </summary>
+		void attach(unsigned char* _moveMaskList);
+
+		/// <summary>
+		/// Compute again the masks of a rectangle of cells that has changed and of the cells around it, the grid must already hold the new cells.
+		/// </summary>
+		void setCellsChanged(const NavigationGrid& _grid, int _x, int _y, int _width, int _depth);
+
+		/// <summary>
+		/// Forget the masks of a page that is unloaded and give back their memory, they are computed again when the page is loaded.
+		/// </summary>
+		void unloadPage(int _page);
+
+		inline unsigned char getMoveMask(int _index) const { return mMoveMaskList[_index]; }
+
+		/// <summary>
+		/// Number of bytes used by the masks of the loaded pages, the masks of a snapshot are not counted.
+		/// </summary>
+		size_t getMemorySize(const NavigationGrid& _grid) const;
+
+
+	private:
+
+		unsigned char computeMoveMask(const NavigationGrid& _grid, int _x, int _y) const;
+	};
+
+}
+
+#endif
@@ -28,6 +28,20 @@ namespace fournier
 	{
 	}
 
+	WorldPosition::WorldPosition(const WorldPosition& _other)
+		: x(_other.x), y(_other.y), z(_other.z)
+	{
+	}
+
+	WorldPosition& WorldPosition::operator = (const WorldPosition& _other)
+	{
+		x = _other.x;
+		y = _other.y;
+		z = _other.z;
+
+		return *this;
+	}
+
 	WorldPosition::WorldPosition(WorldPosition&& _other)
 		: x(0), y(0), z(0)
 	{
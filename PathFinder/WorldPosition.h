@@ -25,6 +25,10 @@ namespace fournier
 		WorldPosition(int _x, int _y, int _z);
 		~WorldPosition();
 
+		// Copy
+		WorldPosition(const WorldPosition &_other);
+		WorldPosition& operator = (const WorldPosition &_other);
+
 		// Move
 		WorldPosition(WorldPosition &&_other);
 		WorldPosition& operator = (WorldPosition &&_other);